@@ -0,0 +1,202 @@
+// distributed under the mit license
+// https://opensource.org/licenses/mit-license.php
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include "pool_arena.h"
+
+// Arena size and its fragmentation: NB_HOLE holes too narrow for the benchmark's blocks
+#define ARENA_SIZE (4 * 1024 * 1024)
+#define NB_HOLE 1000
+#define HOLE_SIZE 32
+// Blocks allocated then released in LIFO order per round
+#define NB_BLK 64
+#define NB_ROUND 20000
+#define NB_RUN 5
+#define NB_SAMPLE 1000
+#define LINE_SIZE 64
+// Rounds timed one operation at a time for the worst-case latency
+#define NB_LAT_ROUND 2000
+#define NB_LAT (NB_LAT_ROUND * NB_BLK)
+#define NB_LAT_RUN 20
+
+static void * arena;
+static void * snapshot;
+static void * holes[2 * NB_HOLE];
+static void * blks[NB_BLK];
+static unsigned long long lat_malloc[NB_LAT];
+static unsigned long long lat_free[NB_LAT];
+
+
+static double now(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+
+// Cycle counter: the time-stamp counter on x86, the cycle CSR on RISCV, otherwise nanoseconds
+static unsigned long long cycles(void) {
+	#if defined(__x86_64__) || defined(__i386__)
+	return __rdtsc();
+	#elif defined(__riscv)
+	unsigned long cnt;
+	__asm__ volatile ("rdcycle %0" : "=r"(cnt));
+	return cnt;
+	#else
+	return (unsigned long long)now();
+	#endif
+}
+
+
+// Size of the i-th block of a round, between 16 and 256 bytes
+static unsigned int blk_size(int i) {
+	return 16 + (i * 53) % 241;
+}
+
+
+// Splits the head of the arena in holes separated by allocated blocks
+static void fragment(int mode) {
+
+	if (pool_init_mode(arena, ARENA_SIZE, mode) != 0) {
+		printf("ERROR: Failed to init the arena\n");
+		exit(1);
+	}
+	for (int i=0; i<2*NB_HOLE; i++)
+		holes[i] = pool_malloc(HOLE_SIZE);
+	for (int i=0; i<2*NB_HOLE; i+=2)
+		pool_free(holes[i]);
+}
+
+
+// Number of cache lines of the arena modified since the snapshot
+static int dirty_lines(void) {
+
+	int cnt = 0;
+
+	for (int i=0; i<ARENA_SIZE; i+=LINE_SIZE)
+		cnt += memcmp((char *)arena + i, (char *)snapshot + i, LINE_SIZE) != 0;
+	return cnt;
+}
+
+
+// -----------------------------------------------------------------------------------------------
+// Runs a mode: rounds of NB_BLK allocations released in LIFO order in the fragmented arena, then
+// the average number of cache lines written by a malloc, measured by comparing the arena
+// against a copy taken just before
+// -----------------------------------------------------------------------------------------------
+static void run(const char * name, int mode) {
+
+	double start;
+	double elapsed = 0;
+	long lines = 0;
+
+	fragment(mode);
+	// Best of NB_RUN to filter out the noise of the system
+	for (int n=0; n<NB_RUN; n++) {
+		start = now();
+		for (int r=0; r<NB_ROUND; r++) {
+			for (int i=0; i<NB_BLK; i++)
+				blks[i] = pool_malloc(blk_size(i + r));
+			for (int i=NB_BLK-1; i>=0; i--)
+				pool_free(blks[i]);
+		}
+		start = now() - start;
+		if (n == 0 || start < elapsed)
+			elapsed = start;
+	}
+
+	for (int s=0; s<NB_SAMPLE; s++) {
+		memcpy(snapshot, arena, ARENA_SIZE);
+		blks[0] = pool_malloc(blk_size(s));
+		lines += dirty_lines();
+		pool_free(blks[0]);
+	}
+
+	if (pool_check() != 0) {
+		printf("ERROR: %s corrupted the arena\n", name);
+		exit(1);
+	}
+
+	printf("%-24s %8.1f ns per malloc/free %8.2f lines per malloc\n", name,
+		   elapsed / (NB_ROUND * NB_BLK), (double)lines / NB_SAMPLE);
+}
+
+
+// -----------------------------------------------------------------------------------------------
+// Runs a mode for its worst-case latency: the rounds of run() timed one malloc or free at a time
+// in cycles, the counter's overhead included. The arena is fragmented again before each run so
+// the runs replay the same operations: an operation keeps its fastest time over the runs, which
+// filters out the interrupts, and the slowest operation is reported
+// -----------------------------------------------------------------------------------------------
+static void latency(const char * name, int mode) {
+
+	unsigned long long start;
+	unsigned long long max_malloc = 0;
+	unsigned long long max_free = 0;
+	int op;
+
+	for (int n=0; n<NB_LAT_RUN; n++) {
+		fragment(mode);
+		op = 0;
+		for (int r=0; r<NB_LAT_ROUND; r++) {
+			for (int i=0; i<NB_BLK; i++) {
+				start = cycles();
+				blks[i] = pool_malloc(blk_size(i + r));
+				start = cycles() - start;
+				if (n == 0 || start < lat_malloc[op + i])
+					lat_malloc[op + i] = start;
+			}
+			for (int i=NB_BLK-1; i>=0; i--) {
+				start = cycles();
+				pool_free(blks[i]);
+				start = cycles() - start;
+				if (n == 0 || start < lat_free[op + i])
+					lat_free[op + i] = start;
+			}
+			op += NB_BLK;
+		}
+	}
+
+	for (int i=0; i<NB_LAT; i++) {
+		if (lat_malloc[i] > max_malloc)
+			max_malloc = lat_malloc[i];
+		if (lat_free[i] > max_free)
+			max_free = lat_free[i];
+	}
+
+	printf("%-24s %8llu cycles max per malloc %8llu cycles max per free\n", name,
+		   max_malloc, max_free);
+}
+
+
+int main(void) {
+
+	arena = malloc(ARENA_SIZE);
+	snapshot = malloc(ARENA_SIZE);
+
+	run("list", POOL_MODE_LIST);
+	run("list, tail", POOL_MODE_LIST | POOL_OPT_TAIL);
+	run("list, quick", POOL_MODE_LIST | POOL_OPT_QUICK);
+	run("segregated", POOL_MODE_SEGREGATED);
+	run("segregated, tail", POOL_MODE_SEGREGATED | POOL_OPT_TAIL);
+	run("tree", POOL_MODE_TREE);
+	run("tree, tail", POOL_MODE_TREE | POOL_OPT_TAIL);
+	run("soa", POOL_MODE_SOA);
+	run("soa, tail", POOL_MODE_SOA | POOL_OPT_TAIL);
+
+	latency("list", POOL_MODE_LIST);
+	latency("segregated", POOL_MODE_SEGREGATED);
+	latency("tlsf", POOL_MODE_TLSF);
+
+	free(snapshot);
+	free(arena);
+
+	return 0;
+}
@@ -2,30 +2,166 @@
 // https://opensource.org/licenses/mit-license.php
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include "pool_arena.h"
+#include "pool_engine.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
 // -----------------------------------------------------------------------------------------------
 // Local declarations
 // -----------------------------------------------------------------------------------------------
 
 // The basic data structure describing a free space arena element
+#if POOL_ARENA_COMPACT
+// Compact layout: a link is the offset of the block from the arena's start, biased by a
+// register so 0 still means not assigned, converted with blk_ptr() / blk_link()
+typedef unsigned int blk_link_t;
+#else
+typedef struct blk * blk_link_t;
+#endif
+
 struct blk {
     // Size of the data payload
-    unsigned int size;
+    pool_size_t size;
     // Pointer to the previous block. 0 means not assigned
-    struct blk * prv;
+    blk_link_t prv;
     // Pointer to the next block. 0 means not assigned
-    struct blk * nxt;
+    blk_link_t nxt;
+    // Links of the free blocks' index, only used (and stored) in segregated
+    // and tree modes: previous/next blocks of the same size class, or
+    // left/right children in the tree
+    union {
+        blk_link_t bin_prv;
+        blk_link_t left;
+    };
+    union {
+        blk_link_t bin_nxt;
+        blk_link_t right;
+    };
 };
 
 typedef struct blk blk_t;
 
-// Size of a memory element, 32 or 64 bits
+#if POOL_ARENA_BTAG
+// Boundary tags: the two LSBs of the size register flag if the block and
+// its previous neighbor are in use. A free block also copies its size in
+// its last register (footer) so its next neighbor can reach it
+#define BLK_INUSE ((pool_size_t)0x1)
+#define BLK_PINUSE ((pool_size_t)0x2)
+#else
+#define BLK_INUSE ((pool_size_t)0x0)
+#define BLK_PINUSE ((pool_size_t)0x0)
+#endif
+#if POOL_ARENA_BTAG
+// The two MSBs of an allocated block's size register flag the lifetime hint
+// given to pool_malloc_hint(), the LSBs being used by the boundary tags. An
+// arena too wide for them has no hint, its sizes owning all the bits
+#define BLK_SHORT ((pool_size_t)1 << (8 * sizeof(pool_size_t) - 2))
+#define BLK_LONG ((pool_size_t)1 << (8 * sizeof(pool_size_t) - 1))
+#define BLK_HINTS hint_bits
+static pool_size_t hint_bits;
+#else
+// The two LSBs of an allocated block's size register, the sizes being multiple
+// of registers, flag the lifetime hint given to pool_malloc_hint()
+#define BLK_SHORT ((pool_size_t)0x1)
+#define BLK_LONG ((pool_size_t)0x2)
+#define BLK_HINTS (BLK_SHORT | BLK_LONG)
+#endif
+#define BLK_FLAGS (BLK_INUSE | BLK_PINUSE | BLK_HINTS)
+
+// Size of a memory element, 32 or 64 bits, always 32 bits with the compact layout
+#if POOL_ARENA_COMPACT
+static const unsigned int reg_size = 4;
+#else
 const static unsigned int reg_size = sizeof(void *);
+#endif
 const static unsigned int log2_reg_size = (reg_size == 4) ? 2 : 3;
-// Size of a block header: size, previous & next block addresses
-const static unsigned int header_size = 3 * reg_size;
+// Minimum payload of a block, so it can store its links once released:
+// prv/nxt in list mode, prv/nxt + the index links in segregated and tree modes
+static unsigned int min_payload;
+// Size of a block header: size, previous & next block addresses (+ size
+// class links in segregated mode)
+static unsigned int header_size;
+
+// Allocation engine and placement policy selected in pool_init_mode()
+static int pool_mode;
+static int pool_policy;
+// POOL_OPT_* options of the list engine's modes
+static int pool_opts;
+// Engine managing the arena on its own, NULL for the list engine's modes
+static const pool_engine_t * engine;
+
+// Tree mode: the free blocks are stored in a treap ordered by size then
+// address, the priority of a node being a hash of its address
+static blk_t * tree_root;
+
+// SoA mode: the offsets and the sizes of the free blocks are stored in two
+// arrays at the head of the arena, sorted by address
+static pool_size_t * soa_off;
+static pool_size_t * soa_len;
+static pool_size_t soa_cnt;
+static pool_size_t soa_cap;
+// Entry of the block selected by get_soa_to_place()
+static pool_size_t soa_slot;
+
+// Quick bins: LIFO lists of the small blocks released, one per payload size
+// in registers. The blocks stay flagged in use, so they're never merged
+// until pool_consolidate() releases them
+#define NB_QUICK 16
+static blk_t * quick_bins[NB_QUICK];
+static pool_size_t nb_quick_blk;
+static pool_size_t quick_space;
+
+// Adaptive mode: histogram of the payload sizes in registers requested by
+// malloc. Every POOL_ARENA_ADAPT_WINDOW mallocs, the NB_HOT most requested
+// sizes get a dedicated LIFO list, cached like the quick bins. The counts
+// are then halved, so the hot sizes follow the traffic of the application
+#define NB_HOT 4
+#define NB_ADAPT 64
+static unsigned int adapt_hist[NB_ADAPT];
+static unsigned int adapt_cnt;
+static pool_size_t hot_size[NB_HOT];
+static blk_t * hot_bins[NB_HOT];
+
+// Zones: runs of blocks of the sizes declared to pool_init_zones(), carved
+// at init and cached like the quick bins. Their blocks are never merged nor
+// released in the free space, so a zone stays contiguous
+static unsigned int nb_zone;
+static pool_size_t zone_size[POOL_ARENA_ZONES];
+static char * zone_lo[POOL_ARENA_ZONES];
+static char * zone_hi[POOL_ARENA_ZONES];
+static blk_t * zone_bins[POOL_ARENA_ZONES];
+
+// Scopes: the outermost scope carves a region from the arena, the blocks
+// allocated inside the scopes are bumped in it. A scope marks the top of
+// the region when it begins and restores it when it ends
+static unsigned int nb_scope;
+static char * scope_lo;
+static char * scope_hi;
+static char * scope_top;
+static char * scope_mark[POOL_ARENA_SCOPES];
+
+// Arguments of the last pool_init_mode() and pool_init_zones(), to reset the arena
+static void * init_addr;
+static pool_size_t init_size;
+static int init_mode;
+static unsigned int init_nb_zone;
+static pool_zone_t init_zones[POOL_ARENA_ZONES];
+
+// Segregated mode: the free blocks are chained per size class. A class is
+// a power of two split in 4 linear sub-classes, so 32 x 4 classes cover
+// the whole sizes range. A bitmap flags the non-empty classes.
+#define LOG2_SUB_CLASS 2
+#define NB_SUB_CLASS (1 << LOG2_SUB_CLASS)
+#define NB_CLASS (8 * sizeof(pool_size_t) * NB_SUB_CLASS)
+static blk_t * bins[NB_CLASS];
+static unsigned int bin_map[NB_CLASS / 32];
 
 // Current free space manipulated by the arena
 static blk_t * current;
@@ -35,12 +171,16 @@ static blk_t * tmp_blk;
 static void * tmp_pt;
 static void * pool_addr;
 
+// Blocks allocated and their payload per lifetime hint, short then long
+static pool_size_t nb_hint_blk[2];
+static pool_size_t hint_space[2];
+
 // Used to track arena status during usage and check if no leaks occur
-static unsigned int pool_size;
-static int nb_alloc_blk;
-static int nb_free_blk;
-static unsigned int alloc_space;
-static unsigned int free_space;
+static pool_size_t pool_size;
+static pool_size_t nb_alloc_blk;
+static pool_size_t nb_free_blk;
+static pool_size_t alloc_space;
+static pool_size_t free_space;
 
 /*
  * Internal functions
@@ -49,7 +189,60 @@ static unsigned int free_space;
 // Find free space when freeing
 static inline void * get_loc_to_free(void * addr);
 // Find free space when allocating
-static inline void * get_loc_to_place(void * addr, unsigned int place);
+static inline void * get_loc_to_place(void * addr, pool_size_t place);
+// Find free space when allocating from one end of the arena
+static inline void * get_end_to_place(void * addr, pool_size_t place, int high);
+// Find free space when allocating in segregated mode
+static inline void * get_bin_to_place(pool_size_t size);
+// Block addressed by a link, and link to a block
+static inline blk_t * blk_ptr(blk_link_t link);
+static inline blk_link_t blk_link(void * blk);
+// Size of a block without the boundary tags' flags
+static inline pool_size_t blk_size(blk_t * blk);
+// Write the footer of a free block (boundary tags only)
+static inline void blk_set_footer(blk_t * blk);
+// Block physically following a block
+static inline blk_t * blk_next(blk_t * blk);
+// Chain / unchain a free block in its size class
+static inline void bin_insert(blk_t * blk);
+static inline void bin_remove(blk_t * blk);
+// Find free space when allocating in tree mode
+static inline void * get_tree_to_place(pool_size_t size);
+// Insert / remove a free block in the tree
+static blk_t * tree_insert(blk_t * root, blk_t * blk);
+static blk_t * tree_remove(blk_t * root, blk_t * blk);
+// Walk the tree to check it, or to print it
+static pool_size_t tree_check(blk_t * node, blk_t * lo, blk_t * hi, pool_size_t * space, int * err);
+static void tree_log(blk_t * node, int depth);
+// Find free space when allocating in SoA mode
+static inline void * get_soa_to_place(pool_size_t size, int high);
+// Insert / remove a free block in the side arrays
+static inline void soa_insert(blk_t * blk);
+static inline void soa_remove(blk_t * blk);
+// Chain a released block back in the free space
+static int blk_release(void * addr);
+// Grow or shrink an allocated block in place
+static int blk_resize(blk_t * blk, pool_size_t payload);
+// Chain / unchain a block in a cache list
+static inline void cache_push(blk_t ** bin, blk_t * blk);
+static inline blk_t * cache_pop(blk_t ** bin);
+// Cache / take back a small block in its quick bin
+static inline int quick_push(blk_t * blk);
+static inline void * quick_pop(pool_size_t payload);
+// Learn the hot sizes, and cache / take back a block in their lists
+static void adapt_update(void);
+static inline int hot_push(blk_t * blk);
+static inline void * hot_pop(pool_size_t payload);
+// Take back / cache a block of a zone
+static inline void * zone_pop(pool_size_t payload);
+static inline int zone_push(blk_t * blk);
+// Bump a block in the region of the scopes
+static inline void * scope_bump(pool_size_t size, pool_size_t align);
+// Check a block belongs to the region of the scopes
+static inline int scope_owns(void * addr);
+// Chain / unchain a free block in the index of the segregated, tree or SoA mode
+static inline void index_insert(blk_t * blk);
+static inline void index_remove(blk_t * blk);
 
 
 // -----------------------------------------------------------------------------------------------
@@ -62,7 +255,44 @@ static inline void * get_loc_to_place(void * addr, unsigned int place);
 // Returns:
 //  - -1 if size is too small to contain at least 1 byte, otherwise 0
 // -----------------------------------------------------------------------------------------------
-int pool_init(void * addr, unsigned int size) {
+int pool_init(void * addr, pool_size_t size) {
+
+	return pool_init_mode(addr, size, POOL_MODE_LIST | POOL_ARENA_POLICY);
+}
+
+
+// Keeps the arguments of a valid init for pool_reset(), the scopes and the
+// zones being dropped with the previous arena
+static inline void init_keep(void * addr, pool_size_t size, int mode) {
+
+	init_addr = addr;
+	init_size = size;
+	init_mode = mode;
+	init_nb_zone = 0;
+	nb_scope = 0;
+}
+
+
+// -----------------------------------------------------------------------------------------------
+// Same than pool_init() but selects the allocation engine
+//
+// Arguments:
+//  - addr: address of the arena's first byte
+//  - size: size in byte available for the arena
+//  - mode: POOL_MODE_LIST, POOL_MODE_SEGREGATED, POOL_MODE_TREE, POOL_MODE_SOA,
+//          POOL_MODE_TLSF, POOL_MODE_BUDDY, POOL_MODE_BITMAP or POOL_MODE_RING, or'ed with a
+//          POOL_FIT_* placement policy and POOL_OPT_* options
+// Returns:
+//  - -1 if size is too small to contain at least 1 byte or mode is unknown, otherwise 0
+// -----------------------------------------------------------------------------------------------
+int pool_init_mode(void * addr, pool_size_t size, int mode) {
+
+	int policy = mode & POOL_FIT_MASK;
+	int opts = mode & POOL_OPT_MASK;
+	void * arg_addr = addr;
+	pool_size_t arg_size = size;
+	pool_size_t offset;
+	mode &= ~(POOL_FIT_MASK | POOL_OPT_MASK);
 
 	#ifdef POOL_ARENA_DEBUG
 	printf("------------------------------------------------------------------------\n");
@@ -75,11 +305,73 @@ int pool_init(void * addr, unsigned int size) {
 		return -1;
 	}
 
+	// Other engines manage the arena on their own
+	engine = (mode == POOL_MODE_TLSF) ? &tlsf_engine :
+			 (mode == POOL_MODE_BUDDY) ? &buddy_engine :
+			 (mode == POOL_MODE_BITMAP) ? &bitmap_engine :
+			 (mode == POOL_MODE_RING) ? &ring_engine : NULL;
+	if (engine != NULL) {
+		if (size > ~0u)
+			size = ~0u;
+		if (engine->init(addr, (unsigned int)size) != 0) {
+			engine = NULL;
+			return -1;
+		}
+		pool_mode = mode;
+		pool_policy = policy;
+		init_keep(arg_addr, arg_size, mode | policy | opts);
+		return 0;
+	}
+
+	if (mode == POOL_MODE_LIST || mode == POOL_MODE_SOA) {
+		min_payload = 2 * reg_size;
+	} else if (mode == POOL_MODE_SEGREGATED || mode == POOL_MODE_TREE) {
+		min_payload = 4 * reg_size;
+	} else {
+		#ifdef POOL_ARENA_DEBUG
+		printf("ERROR: Unknown allocation mode %d\n", mode);
+		#endif
+		return -1;
+	}
+	#if POOL_ARENA_BTAG
+	// A free block also needs a footer
+	min_payload += reg_size;
+	#endif
+	header_size = reg_size + min_payload;
+
+	// Blocks are multiple of registers, the tail not covered is not used
+	size &= ~(pool_size_t)(reg_size - 1);
+
+	// The SoA side arrays are placed at the head of the arena. Two free blocks are never
+	// contiguous, so there can't be more than one free block per two minimal blocks
+	if (mode == POOL_MODE_SOA) {
+		soa_cap = size / (2 * header_size + 2 * sizeof(pool_size_t)) + 1;
+		soa_cnt = 0;
+		soa_off = addr;
+		soa_len = soa_off + soa_cap;
+		offset = (2 * soa_cap * sizeof(pool_size_t) + reg_size - 1) & ~(pool_size_t)(reg_size - 1);
+		if (size < offset)
+			return -1;
+		addr = (char *)addr + offset;
+		size -= offset;
+	}
+
 	// size is too small, can't even store a header
     if (size <= header_size) {
         return -1;
 	}
 
+	engine = NULL;
+	pool_mode = mode;
+	pool_policy = policy;
+	pool_opts = opts;
+	#if POOL_ARENA_BTAG
+	// The MSBs of the size registers store the lifetime hints only if the arena is under
+	// 1 GB (4 EB if wide), a wider arena's blocks needing them for their size
+	hint_bits = (size < BLK_SHORT) ? (BLK_SHORT | BLK_LONG) : 0;
+	#endif
+	init_keep(arg_addr, arg_size, mode | policy | opts);
+
     tmp_blk = 0;
     tmp_pt = 0;
 
@@ -91,22 +383,48 @@ int pool_init(void * addr, unsigned int size) {
     free_space = size - reg_size;
 
     current = (blk_t *)addr;
-    current->size = free_space;
-    current->prv = NULL;
-    current->nxt = NULL;
+    current->size = free_space | BLK_PINUSE;
+    current->prv = blk_link(NULL);
+    current->nxt = blk_link(NULL);
+	blk_set_footer(current);
+
+	memset(bins, 0, sizeof(bins));
+	memset(bin_map, 0, sizeof(bin_map));
+	memset(quick_bins, 0, sizeof(quick_bins));
+	nb_quick_blk = 0;
+	quick_space = 0;
+	memset(adapt_hist, 0, sizeof(adapt_hist));
+	adapt_cnt = 0;
+	memset(hot_size, 0, sizeof(hot_size));
+	memset(hot_bins, 0, sizeof(hot_bins));
+	nb_zone = 0;
+	memset(nb_hint_blk, 0, sizeof(nb_hint_blk));
+	memset(hint_space, 0, sizeof(hint_space));
+	tree_root = NULL;
+	index_insert(current);
 
     #ifdef POOL_ARENA_DEBUG
     printf("Architecture/Library Setup:\n");
     printf("  - register size: %d bytes\n", reg_size);
     printf("  - header size: %d bytes\n", header_size);
-    printf("  - pool size: %d bytes\n", size);
+    printf("  - mode: %s\n", (pool_mode == POOL_MODE_SEGREGATED) ? "segregated" :
+                              (pool_mode == POOL_MODE_TREE) ? "tree" :
+                              (pool_mode == POOL_MODE_SOA) ? "soa" : "list");
+    printf("  - policy: %s\n", (pool_policy == POOL_FIT_FIRST) ? "first-fit" :
+                                (pool_policy == POOL_FIT_BEST) ? "best-fit" :
+                                (pool_policy == POOL_FIT_WORST) ? "worst-fit" : "next-fit");
+    printf("  - tail carving: %s\n", (pool_opts & POOL_OPT_TAIL) ? "yes" : "no");
+    printf("  - quick bins: %s\n", (pool_opts & POOL_OPT_QUICK) ? "yes" : "no");
+    printf("  - double-ended: %s\n", (pool_opts & POOL_OPT_DOUBLE) ? "yes" : "no");
+    printf("  - adaptive: %s\n", (pool_opts & POOL_OPT_ADAPT) ? "yes" : "no");
+    printf("  - pool size: %lu bytes\n", (unsigned long)size);
     printf("\n");
 
     printf("Init pool arena:\n");
     printf("  - addr: %p\n", addr);
-    printf("  - size: %d\n", current->size);
-    printf("  - prv: %p\n", (void *)current->prv);
-    printf("  - nxt: %p\n", (void *)current->nxt);
+    printf("  - size: %lu\n", (unsigned long)blk_size(current));
+    printf("  - prv: %p\n", (void *)blk_ptr(current->prv));
+    printf("  - nxt: %p\n", (void *)blk_ptr(current->nxt));
     printf("\n");
     #endif
 
@@ -118,6 +436,53 @@ int pool_init(void * addr, unsigned int size) {
 }
 
 
+// Block addressed by a link stored in a free block, NULL if not assigned
+static inline blk_t * blk_ptr(blk_link_t link) {
+	#if POOL_ARENA_COMPACT
+	return link ? (blk_t *)((char *)pool_addr + link - reg_size) : NULL;
+	#else
+	return link;
+	#endif
+}
+
+
+// Link to store in a free block to address a block, which may be NULL
+static inline blk_link_t blk_link(void * blk) {
+	#if POOL_ARENA_COMPACT
+	return blk ? (unsigned int)((char *)blk - (char *)pool_addr) + reg_size : 0;
+	#else
+	return blk;
+	#endif
+}
+
+
+// Size of a block without the boundary tags' flags
+static inline pool_size_t blk_size(blk_t * blk) {
+	return blk->size & ~BLK_FLAGS;
+}
+
+
+// Copies the size of a free block in its last register
+static inline void blk_set_footer(blk_t * blk) {
+	#if POOL_ARENA_BTAG
+	*(pool_size_t *)((char *)blk + blk_size(blk)) = blk_size(blk);
+	#else
+	(void)blk;
+	#endif
+}
+
+
+// Returns the block physically following blk, NULL if blk is the last of the arena
+static inline blk_t * blk_next(blk_t * blk) {
+
+	char * nxt = (char *)blk + blk_size(blk) + reg_size;
+
+	if (nxt >= (char *)pool_addr + pool_size)
+		return NULL;
+	return (blk_t *)nxt;
+}
+
+
 // -----------------------------------------------------------------------------------------------
 // To round up a size to the next multiple of 32 or 64 bits size
 //
@@ -126,17 +491,106 @@ int pool_init(void * addr, unsigned int size) {
 // Returns:
 //  - the number of bytes rounds up to the architcture width
 // -----------------------------------------------------------------------------------------------
-static inline int round_up(unsigned int * x) {
+static inline pool_size_t round_up(pool_size_t * x) {
 
 	if (reg_size == 4)
-		return (0 == (*x & 0x3)) ? *x : ((*x + 4) & ~3u);
+		return (0 == (*x & 0x3)) ? *x : ((*x + 4) & ~(pool_size_t)3);
 	else
-		return (0 == (*x & 0x7)) ? *x : ((*x + 8) & ~7u);
+		return (0 == (*x & 0x7)) ? *x : ((*x + 8) & ~(pool_size_t)7);
 
     /* return ((*x + 7) >> log2_reg_size) << log2_reg_size; */
 }
 
 
+// -----------------------------------------------------------------------------------------------
+// Same than pool_init() but reserves at the head of the arena a zone per object size declared.
+// A zone is carved in count blocks of its size, so a malloc() of that size takes the last block
+// released in constant time, without parsing the free space, until the zone is exhausted
+//
+// Arguments:
+//  - addr: address of the arena's first byte
+//  - size: size in byte available for the arena
+//  - zones: the object sizes and their count
+//  - n: the number of zones, up to POOL_ARENA_ZONES
+// Returns:
+//  - -1 if the zones are invalid or can't be stored in the arena, otherwise 0
+// -----------------------------------------------------------------------------------------------
+int pool_init_zones(void * addr, pool_size_t size, const pool_zone_t * zones, unsigned int n) {
+
+	blk_t * blk;
+	char * zone;
+	pool_size_t payload[POOL_ARENA_ZONES];
+	pool_size_t span = 0;
+	pool_size_t end;
+	pool_size_t cnt = 0;
+
+	if (n > POOL_ARENA_ZONES || (n > 0 && zones == NULL))
+		return -1;
+
+	if (pool_init(addr, size) != 0)
+		return -1;
+	if (n == 0)
+		return 0;
+
+	// The blocks of a zone own the payload pool_malloc() computes for the size
+	for (unsigned int i = 0; i < n; i++) {
+		payload[i] = zones[i].size;
+		if (payload[i] == 0 || zones[i].count == 0)
+			return -1;
+		payload[i] = (payload[i] < min_payload) ? min_payload : round_up(&payload[i]);
+		for (unsigned int j = 0; j < i; j++) {
+			if (payload[j] == payload[i])
+				return -1;
+		}
+		if (payload[i] + reg_size > ((pool_size_t)~0 - span) / zones[i].count)
+			return -1;
+		span += (payload[i] + reg_size) * zones[i].count;
+		cnt += zones[i].count;
+	}
+
+	// The zones are allocated as a single block, then split in place
+	zone = pool_malloc(span - reg_size);
+	if (zone == NULL)
+		return -1;
+	zone -= reg_size;
+	end = blk_size((blk_t *)zone) + reg_size;
+	nb_alloc_blk += cnt - 1;
+	alloc_space -= (cnt - 1) * reg_size;
+
+	for (unsigned int i = 0; i < n; i++) {
+
+		zone_size[i] = payload[i];
+		zone_lo[i] = zone;
+		zone_hi[i] = zone + (payload[i] + reg_size) * zones[i].count;
+		zone_bins[i] = NULL;
+		// The last zone owns the tail the allocation may have consumed
+		if (i == n - 1)
+			zone_hi[i] = zone_lo[0] + end;
+
+		// The first block is cached the last, so the zone is handed out by address
+		for (unsigned int j = zones[i].count; j-- > 0;) {
+			blk = (blk_t *)(zone + j * (payload[i] + reg_size));
+			if (j == zones[i].count - 1)
+				blk->size = (zone_hi[i] - (char *)blk - reg_size) | BLK_INUSE | BLK_PINUSE;
+			else
+				blk->size = payload[i] | BLK_INUSE | BLK_PINUSE;
+			cache_push(&zone_bins[i], blk);
+		}
+
+		#ifdef POOL_ARENA_DEBUG
+		printf("  - zone of %d blocks of %lu bytes: %p\n", zones[i].count,
+			   (unsigned long)payload[i], (void *)zone);
+		#endif
+		zone = zone_hi[i];
+		init_zones[i] = zones[i];
+	}
+	nb_zone = n;
+	init_nb_zone = n;
+
+	return 0;
+}
+
+
 // -----------------------------------------------------------------------------------------------
 // Allocates in the arena a buffer of _size_ bytes. Memory blocked reserved in memory are always
 // boundary aligned with the hw architecture, so 4 bytes for 32 bits architecture, or 8 bytes
@@ -147,7 +601,39 @@ static inline int round_up(unsigned int * x) {
 // Returns:
 //  - the address of the buffer's first byte, otherwise -1 if failed
 // -----------------------------------------------------------------------------------------------
-void * pool_malloc(unsigned int size) {
+void * pool_malloc(pool_size_t size) {
+
+	return pool_malloc_hint(size, 0);
+}
+
+
+// Flags an allocated block with its lifetime hint and accounts it
+static inline void * hint_set(void * addr, int hint) {
+
+	blk_t * blk = (blk_t *)((char *)addr - reg_size);
+	int idx = (hint & POOL_HINT_LONG) ? 1 : 0;
+
+	if (hint & (POOL_HINT_SHORT | POOL_HINT_LONG)) {
+		blk->size |= idx ? BLK_LONG : BLK_SHORT;
+		nb_hint_blk[idx] += 1;
+		hint_space[idx] += blk_size(blk);
+	}
+
+	return addr;
+}
+
+
+// -----------------------------------------------------------------------------------------------
+// Same than pool_malloc() but places the block following its expected lifetime: the short-lived
+// blocks from the low end of the arena, the long-lived ones from the high end
+//
+// Argument:
+//  - size: the number of bytes the block needs to own
+//  - hint: POOL_HINT_SHORT, POOL_HINT_LONG, or 0 for pool_malloc()'s placement
+// Returns:
+//  - the address of the buffer's first byte, otherwise -1 if failed
+// -----------------------------------------------------------------------------------------------
+void * pool_malloc_hint(pool_size_t size, int hint) {
 
 	#ifdef POOL_ARENA_DEBUG
 	printf("------------------------------------------------------------------------\n");
@@ -159,8 +645,31 @@ void * pool_malloc(unsigned int size) {
     void * free_loc;
     void * prv_pt;
     void * nxt_pt;
-    unsigned int _size;
-    unsigned int new_size;
+    pool_size_t _size;
+    pool_size_t new_size;
+    pool_size_t payload;
+    pool_size_t flags;
+    int ends;
+    int high;
+    int tail;
+
+	// Inside a scope, the block is bumped in the scope's region
+	if (nb_scope > 0)
+		return scope_bump(size, reg_size);
+
+	// The other engines are limited to 32 bits sizes
+	if (engine != NULL)
+		return (size > ~0u) ? NULL : engine->alloc((unsigned int)size);
+
+	#if POOL_ARENA_BTAG
+	// The arena is too wide to flag the hints in the size registers
+	if ((hint & (POOL_HINT_SHORT | POOL_HINT_LONG)) && hint_bits == 0) {
+		#ifdef POOL_ARENA_DEBUG
+		printf("ERROR: Arena too wide for the lifetime hints\n");
+		#endif
+		return NULL;
+	}
+	#endif
 
 	if (size == 0) {
 		#ifdef POOL_ARENA_DEBUG
@@ -171,100 +680,457 @@ void * pool_malloc(unsigned int size) {
 
 	// A block must be at least 3 registers wide to be able to release
 	// it in free(). A free block must be composed by some size, prv
-	// and nxt fields at minimum
-	if (size<(2*reg_size))
-		_size = 2*reg_size /* prv/nxt*/ + reg_size /* size register */;
+	// and nxt fields at minimum (and the index links in segregated and tree modes)
+	if (size<min_payload)
+		_size = min_payload /* prv/nxt*/ + reg_size /* size register */;
     // Round up the size up to the arch width. Ensure the size is at minimum a register size and
     // a multiple of that register. So if use 64 bits arch, a 4 bytes allocation is round up
     // to 8 bytes, and 28 bytes is round up to 32 bytes, ...
 	else
 		_size = round_up(&size) + reg_size /* size register */;
 
-	// Grab a place for our new shinny chunk
-	loc = get_loc_to_place(current, _size);
+	// No block can be that wide
+	if (_size < size) {
+		#ifdef POOL_ARENA_DEBUG
+		printf("ERROR: Can't allocate a %lu bytes block\n", (unsigned long)size);
+		#endif
+		return NULL;
+	}
+
+	// A block of a zone's size is taken back from the zone
+	if (nb_zone > 0) {
+		loc = zone_pop(_size - reg_size);
+		if (loc != NULL)
+			return hint_set(loc, hint);
+	}
+
+	// A block of the same size recently released is reused as is
+	if (pool_opts & POOL_OPT_QUICK) {
+		loc = quick_pop(_size - reg_size);
+		if (loc != NULL)
+			return hint_set(loc, hint);
+	}
+
+	// Adaptive mode: count the request, and reuse a block of a hot size
+	if (pool_opts & POOL_OPT_ADAPT) {
+		if (_size - reg_size < NB_ADAPT * reg_size)
+			adapt_hist[(_size - reg_size) / reg_size] += 1;
+		if (++adapt_cnt >= POOL_ARENA_ADAPT_WINDOW)
+			adapt_update();
+		loc = hot_pop(_size - reg_size);
+		if (loc != NULL)
+			return hint_set(loc, hint);
+	}
+
+	// Double-ended arena: the large or long-lived blocks are placed from the high end, carved
+	// from the tail of the free block, the small or short-lived ones from the low end
+	ends = (pool_opts & POOL_OPT_DOUBLE) || (hint & (POOL_HINT_SHORT | POOL_HINT_LONG));
+	if (hint & (POOL_HINT_SHORT | POOL_HINT_LONG))
+		high = (hint & POOL_HINT_LONG) != 0;
+	else
+		high = (pool_opts & POOL_OPT_DOUBLE) && _size - reg_size >= POOL_ARENA_LARGE;
+	tail = ends ? high : (pool_opts & POOL_OPT_TAIL);
+
+	// Grab a place for our new shinny chunk, merging back the quick bins
+	// in the free space if none is found
+	do {
+		if (pool_mode == POOL_MODE_SEGREGATED)
+			loc = get_bin_to_place(_size);
+		else if (pool_mode == POOL_MODE_TREE)
+			loc = get_tree_to_place(_size);
+		else if (pool_mode == POOL_MODE_SOA)
+			loc = get_soa_to_place(_size, high);
+		else if (ends)
+			loc = get_end_to_place(current, _size, high);
+		else
+			loc = get_loc_to_place(current, _size);
+	} while (loc == NULL && nb_quick_blk > 0 && pool_consolidate() > 0);
 	free_loc = loc;
 
 	if (loc == NULL) {
 		#ifdef POOL_ARENA_DEBUG
 		printf("ERROR: Can't find a enough space to store a new block\n");
-		printf("  - requested free space: %d\n", size);
-		printf("  - current free space: %d\n", free_space);
+		printf("  - requested free space: %lu\n", (unsigned long)size);
+		printf("  - current free space: %lu\n", (unsigned long)free_space);
 		#endif
 		return NULL;
 	}
 
 	#ifdef POOL_ARENA_DEBUG
 	printf("  - allocated addr: %p\n", loc);
-	printf("  - size requested: %d\n", _size);
+	printf("  - size requested: %lu\n", (unsigned long)_size);
 	printf("  - current free block: %p\n", (void *)current);
 	#endif
 
-    // Update monitoring
-	// ----------------
-	nb_alloc_blk += 1;
-	if (size<(2*reg_size))
-		alloc_space += 2*reg_size;
-	else
-		alloc_space += round_up(&size);
-	free_space -= _size;
-
 	// Update free block
 	// -----------------
 
-	// Save metadata
+	payload = _size - reg_size;
 	tmp_blk = (blk_t *)free_loc;
-    nxt_pt = tmp_blk->nxt;
-    prv_pt = tmp_blk->prv;
-    // Adjust free space  block address and update its metadata
-    new_size = tmp_blk->size - _size;
-    free_loc = (char *)free_loc + _size;
-    tmp_blk = (blk_t *)free_loc;
-	tmp_blk->size = new_size;
-    tmp_blk->prv = prv_pt;
-    tmp_blk->nxt = nxt_pt;
 
-	#ifdef POOL_ARENA_DEBUG
-    printf("  - new free space address: %p\n", free_loc);
-	printf("  - new free space size: %d\n", tmp_blk->size);
-	#endif
+	if (blk_size(tmp_blk) < _size + min_payload) {
+
+		// The remainder would be too small to be a free block: the whole block is consumed and
+		// its slack is folded into the new block
+		index_remove(tmp_blk);
+		if (blk_ptr(tmp_blk->prv) != NULL)
+			blk_ptr(tmp_blk->prv)->nxt = tmp_blk->nxt;
+		if (blk_ptr(tmp_blk->nxt) != NULL)
+			blk_ptr(tmp_blk->nxt)->prv = tmp_blk->prv;
+		current = (blk_ptr(tmp_blk->nxt) != NULL) ? blk_ptr(tmp_blk->nxt) : blk_ptr(tmp_blk->prv);
+		payload = blk_size(tmp_blk);
+		flags = tmp_blk->size & BLK_PINUSE;
+		#if POOL_ARENA_BTAG
+		if (blk_next(tmp_blk) != NULL)
+			blk_next(tmp_blk)->size |= BLK_PINUSE;
+		#endif
 
-    // Update previous block to link current
-    if (prv_pt) {
-        tmp_blk = prv_pt;
-        tmp_blk->nxt = free_loc;
-    }
+		#ifdef POOL_ARENA_DEBUG
+		printf("  - free block consumed, slack: %lu\n", (unsigned long)(payload - (_size - reg_size)));
+		#endif
 
-    tmp_blk = (blk_t *)free_loc;
-    // Update next block to link current, only if exists
-    if (nxt_pt) {
-        tmp_blk = nxt_pt;
-        tmp_blk->prv = free_loc;
-    }
+		nb_free_blk -= 1;
+		free_space -= payload;
+
+	} else if (tail) {
+
+		// Carve the new block from the tail of the free block: only its size changes, it keeps
+		// its place in the linked list and its neighbors' links are untouched
+		if (pool_mode != POOL_MODE_SOA)
+			index_remove(tmp_blk);
+		new_size = blk_size(tmp_blk) - _size;
+		tmp_blk->size = new_size | (tmp_blk->size & BLK_PINUSE);
+		blk_set_footer(tmp_blk);
+		if (pool_mode == POOL_MODE_SOA)
+			soa_len[soa_slot] = new_size;
+		else
+			index_insert(tmp_blk);
+		loc = (char *)free_loc + reg_size + new_size;
+		// The new block follows a free block, the next one now follows an allocated block
+		flags = 0;
+		#if POOL_ARENA_BTAG
+		if ((char *)loc + _size < (char *)pool_addr + pool_size)
+			((blk_t *)((char *)loc + _size))->size |= BLK_PINUSE;
+		#endif
+
+		#ifdef POOL_ARENA_DEBUG
+		printf("  - new free space size: %lu\n", (unsigned long)new_size);
+		#endif
+
+		free_space -= _size;
+		current = free_loc;
+
+	} else {
+
+		// Save metadata
+		// The SoA entry is updated in place below, the block keeps its rank
+		if (pool_mode != POOL_MODE_SOA)
+			index_remove(tmp_blk);
+	    nxt_pt = blk_ptr(tmp_blk->nxt);
+	    prv_pt = blk_ptr(tmp_blk->prv);
+	    flags = tmp_blk->size & BLK_PINUSE;
+	    // Adjust free space  block address and update its metadata
+	    new_size = blk_size(tmp_blk) - _size;
+	    free_loc = (char *)free_loc + _size;
+	    tmp_blk = (blk_t *)free_loc;
+		// The new chunk is placed just before
+		tmp_blk->size = new_size | BLK_PINUSE;
+	    tmp_blk->prv = blk_link(prv_pt);
+	    tmp_blk->nxt = blk_link(nxt_pt);
+		blk_set_footer(tmp_blk);
+		if (pool_mode == POOL_MODE_SOA) {
+			soa_off[soa_slot] = (char *)tmp_blk - (char *)pool_addr;
+			soa_len[soa_slot] = new_size;
+		} else {
+			index_insert(tmp_blk);
+		}
+
+		#ifdef POOL_ARENA_DEBUG
+	    printf("  - new free space address: %p\n", free_loc);
+		printf("  - new free space size: %lu\n", (unsigned long)blk_size(tmp_blk));
+		#endif
+
+	    // Update previous block to link current
+	    if (prv_pt) {
+	        tmp_blk = prv_pt;
+	        tmp_blk->nxt = blk_link(free_loc);
+	    }
+
+	    tmp_blk = (blk_t *)free_loc;
+	    // Update next block to link current, only if exists
+	    if (nxt_pt) {
+	        tmp_blk = nxt_pt;
+	        tmp_blk->prv = blk_link(free_loc);
+	    }
+
+		free_space -= _size;
+		// Move the head pointer of the free space linked list
+		current = free_loc;
+	}
 
-	// Move the head pointer of the free space linked list
-	current = free_loc;
+    // Update monitoring
+	// ----------------
+	nb_alloc_blk += 1;
+	alloc_space += payload;
 
 	// Setup data block
 	// ----------------
 
 	// Set the new chunk's size
 	tmp_blk = (blk_t *)loc;
-	if (size<(2*reg_size))
-		tmp_blk->size = reg_size*2;
-	else
-		tmp_blk->size = round_up(&size);
+	tmp_blk->size = payload | BLK_INUSE | flags;
     // Payload's address the application can use
     loc = (char *)loc + reg_size;
     #ifdef POOL_ARENA_DEBUG
 	printf("------------------------------------------------------------------------\n");
     #endif
 
-    return loc;
+    return hint_set(loc, hint);
+}
+
+
+// -----------------------------------------------------------------------------------------------
+// Allocates a block whose payload is aligned on alignment bytes. In the list engine's modes, a
+// free block wide enough for the payload and the worst-case slack is forked, then the leading
+// slack is split as a block of its own and released in the free space, as the unused tail: the
+// result is a regular block, with its size register before the payload. The other engines only
+// return the block if aligned: the buddy engine's blocks are aligned on their size, up to 64 bytes.
+//
+// Arguments:
+//  - alignment: the alignment of the payload in bytes, a power of two
+//  - size: the number of bytes the block needs to own
+// Returns:
+//  - the address of the buffer's first byte, NULL if failed or alignment is not a power of two
+// -----------------------------------------------------------------------------------------------
+void * pool_aligned_alloc(pool_size_t alignment, pool_size_t size) {
+
+	char * pt;
+	char * aligned;
+	blk_t * blk;
+	pool_size_t over;
+	pool_size_t lead;
+	pool_size_t payload;
+
+	if (alignment == 0 || (alignment & (alignment - 1)) != 0)
+		return NULL;
+
+	if (alignment <= reg_size)
+		return pool_malloc(size);
+
+	if (nb_scope > 0)
+		return scope_bump(size, alignment);
+
+	if (engine != NULL) {
+		pt = pool_malloc((size < alignment) ? alignment : size);
+		if (pt != NULL && (size_t)pt % alignment != 0) {
+			pool_free(pt);
+			pt = NULL;
+		}
+		return pt;
+	}
+
+	// The payload may start up to alignment bytes forward, after a leading block of its own
+	payload = (size < min_payload) ? min_payload : round_up(&size);
+	over = payload + alignment + header_size;
+	if (size == 0 || payload < size || over < payload)
+		return NULL;
+	pt = pool_malloc(over);
+	if (pt == NULL)
+		return NULL;
+	if ((size_t)pt % alignment == 0)
+		aligned = pt;
+	else
+		aligned = pt + header_size + (alignment - ((size_t)pt + header_size) % alignment) % alignment;
+
+	// A block of a zone can't be split, it's only returned if aligned
+	if (nb_zone > 0 && pt >= zone_lo[0] && pt < zone_hi[nb_zone - 1]) {
+		if (aligned == pt)
+			return pt;
+		pool_free(pt);
+		return NULL;
+	}
+
+	// The leading slack is split then released, it merges with the previous block if free
+	if (aligned != pt) {
+		blk = (blk_t *)(pt - reg_size);
+		lead = aligned - pt;
+		((blk_t *)(aligned - reg_size))->size = (blk_size(blk) - lead) | BLK_INUSE | BLK_PINUSE;
+		blk->size = (lead - reg_size) | (blk->size & BLK_FLAGS);
+		nb_alloc_blk += 1;
+		alloc_space -= reg_size;
+
+		#ifdef POOL_ARENA_DEBUG
+		printf("  - aligned addr: %p, leading slack released: %lu\n", (void *)aligned,
+			   (unsigned long)lead);
+		#endif
+
+		blk_release(pt);
+	}
+
+	// Then the tail not needed
+	blk_resize((blk_t *)(aligned - reg_size), payload);
+
+	return aligned;
+}
+
+
+// -----------------------------------------------------------------------------------------------
+// Splits in place an allocated chunk in k contiguous blocks, the last one owning the slack the
+// allocation consumed. Only the first block keeps the chunk's previous neighbor's flag
+//
+// Arguments:
+//  - pt: the chunk's payload
+//  - k: the number of blocks
+//  - payloads: the payload of each block, NULL if all own payload bytes
+//  - payload: the payload of each block if payloads is NULL
+//  - out: the k addresses of the blocks
+// -----------------------------------------------------------------------------------------------
+static void chunk_split(char * pt, unsigned int k, const pool_size_t * payloads,
+						pool_size_t payload, void ** out) {
+
+	blk_t * blk = (blk_t *)(pt - reg_size);
+	char * end = pt + blk_size(blk);
+	pool_size_t flags = blk->size & BLK_PINUSE;
+
+	nb_alloc_blk += k - 1;
+	alloc_space -= (k - 1) * reg_size;
+	for (unsigned int j = 0; j < k; j++) {
+		if (payloads != NULL)
+			payload = payloads[j];
+		if (j == k - 1)
+			payload = end - (char *)blk - reg_size;
+		blk->size = payload | BLK_INUSE | flags;
+		flags = BLK_PINUSE;
+		out[j] = (char *)blk + reg_size;
+		blk = (blk_t *)((char *)blk + reg_size + payload);
+	}
+}
+
+
+// -----------------------------------------------------------------------------------------------
+// Allocates several objects of different sizes living together: a single free block is searched
+// for all of them, then split in place, so the objects are contiguous. Each one is a regular
+// block, released on its own with pool_free()
+//
+// Arguments:
+//  - n: the number of objects, up to POOL_ARENA_COMALLOC
+//  - sizes: the size in bytes of each object
+//  - out: the n addresses of the objects
+// Returns:
+//  - 0 if all the objects have been allocated, -1 otherwise, none being allocated
+// -----------------------------------------------------------------------------------------------
+int pool_comalloc(unsigned int n, const pool_size_t * sizes, void ** out) {
+
+	pool_size_t payloads[POOL_ARENA_COMALLOC];
+	pool_size_t total = 0;
+	pool_size_t size;
+	unsigned int cnt;
+	char * pt = NULL;
+
+	if (n == 0 || n > POOL_ARENA_COMALLOC || sizes == NULL || out == NULL)
+		return -1;
+
+	for (unsigned int i = 0; i < n; i++) {
+		size = sizes[i];
+		payloads[i] = (size < min_payload) ? min_payload : round_up(&size);
+		if (size == 0 || payloads[i] < size || payloads[i] + reg_size > (pool_size_t)~0 - total)
+			return -1;
+		total += payloads[i] + reg_size;
+	}
+
+	// A single chunk with the list engine's modes, the objects being split in place
+	if (engine == NULL && nb_scope == 0) {
+		pt = pool_malloc(total - reg_size);
+		if (pt != NULL && nb_zone > 0 && pt >= zone_lo[0] && pt < zone_hi[nb_zone - 1]) {
+			pool_free(pt);
+			pt = NULL;
+		}
+		if (pt == NULL)
+			return -1;
+		chunk_split(pt, n, payloads, 0, out);
+		return 0;
+	}
+
+	// Else one by one, all or nothing
+	for (cnt = 0; cnt < n; cnt++) {
+		out[cnt] = pool_malloc(sizes[cnt]);
+		if (out[cnt] == NULL) {
+			while (cnt-- > 0)
+				pool_free(out[cnt]);
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
+
+// -----------------------------------------------------------------------------------------------
+// Allocates n blocks of the same size. In the list engine's modes, the blocks are carved from a
+// single allocation of k contiguous blocks, split in place, so a single free block is searched
+// for the batch. If none is wide enough, k is halved until the chunk fits, then the search goes
+// on for the remaining blocks
+//
+// Arguments:
+//  - size: the number of bytes each block needs to own
+//  - n: the number of blocks
+//  - out: the n addresses of the blocks allocated
+// Returns:
+//  - the number of blocks allocated, less than n if the arena is exhausted
+// -----------------------------------------------------------------------------------------------
+unsigned int pool_malloc_batch(pool_size_t size, unsigned int n, void ** out) {
+
+	unsigned int cnt = 0;
+	unsigned int k = n;
+	pool_size_t payload;
+	pool_size_t span;
+	char * pt;
+
+	if (out == NULL)
+		return 0;
+
+	// The other engines and the scopes allocate the blocks one by one
+	payload = (size < min_payload) ? min_payload : round_up(&size);
+	if (engine != NULL || nb_scope > 0 || size == 0 || payload < size) {
+		while (cnt < n && (out[cnt] = pool_malloc(size)) != NULL)
+			cnt++;
+		return cnt;
+	}
+	span = payload + reg_size;
+
+	while (cnt < n && k > 0) {
+
+		if (k > n - cnt)
+			k = n - cnt;
+		if (k > 1 && span > ((pool_size_t)~0 - reg_size) / k) {
+			k /= 2;
+			continue;
+		}
+		pt = pool_malloc((k == 1) ? size : k * span - reg_size);
+		// A block of a zone can't be split
+		if (pt != NULL && k > 1 && nb_zone > 0 && pt >= zone_lo[0] && pt < zone_hi[nb_zone - 1]) {
+			pool_free(pt);
+			pt = NULL;
+		}
+		if (pt == NULL) {
+			k /= 2;
+			continue;
+		}
+
+		chunk_split(pt, k, NULL, payload, out + cnt);
+		cnt += k;
+
+		#ifdef POOL_ARENA_DEBUG
+		printf("  - batch of %d blocks of %lu bytes: %p\n", k, (unsigned long)payload, (void *)pt);
+		#endif
+	}
+
+	return cnt;
 }
 
 
 // memory allocation + clear
-void * pool_calloc(unsigned int size) {
+void * pool_calloc(pool_size_t size) {
 
 	#ifdef POOL_ARENA_DEBUG
 	printf("------------------------------------------------------------------------\n");
@@ -276,7 +1142,7 @@ void * pool_calloc(unsigned int size) {
 	if (ptr == NULL) {
 		#ifdef POOL_ARENA_DEBUG
 		printf("ERROR: Failed to allocate the chunk\n");
-		printf("  - current free space: %d\n", free_space);
+		printf("  - current free space: %lu\n", (unsigned long)free_space);
 		#endif
 		return NULL;
 	}
@@ -286,8 +1152,19 @@ void * pool_calloc(unsigned int size) {
 	return ptr;
 }
 
-// Move a block to a new place
-void * pool_realloc(void * addr, unsigned int size) {
+// -----------------------------------------------------------------------------------------------
+// Resizes a block. In the list engine's modes, the block shrinks in place by releasing its tail
+// in the free space, and grows in place by absorbing its next neighbor if free and wide enough.
+// Else, the block moves to a new place, only min(old, new) bytes being copied. The other
+// engines' blocks, the zones' and the scopes' ones are kept in place only to shrink.
+//
+// Arguments:
+//  - addr: address of the chunk to resize, NULL to allocate a new one
+//  - size: size in byte of the chunk
+// Returns:
+//  - the address of the chunk, NULL if failed, the existing block remaining OK
+// -----------------------------------------------------------------------------------------------
+void * pool_realloc(void * addr, pool_size_t size) {
 
 	#ifdef POOL_ARENA_DEBUG
 	printf("------------------------------------------------------------------------\n");
@@ -295,144 +1172,1086 @@ void * pool_realloc(void * addr, unsigned int size) {
 	printf("------------------------------------------------------------------------\n");
 	#endif
 
-	void * ptr = pool_malloc(size);
+	void * ptr;
+	pool_size_t old;
+	pool_size_t payload;
+
+	if (addr == NULL)
+		return pool_malloc(size);
+	if (size == 0)
+		return NULL;
+
+	old = pool_get_size(addr);
+
+	if (engine == NULL && !scope_owns(addr) &&
+		(nb_zone == 0 || (char *)addr < zone_lo[0] || (char *)addr >= zone_hi[nb_zone - 1])) {
+		payload = (size < min_payload) ? min_payload : round_up(&size);
+		if (payload >= size && blk_resize((blk_t *)((char *)addr - reg_size), payload))
+			return addr;
+	} else if (size <= old) {
+		return addr;
+	}
+
+	ptr = pool_malloc(size);
 
 	if (ptr == NULL) {
 		#ifdef POOL_ARENA_DEBUG
 		printf("ERROR: Failed to allocate the chunk\n");
-		printf("  - requested free space: %d\n", size);
-		printf("  - current free space: %d\n", free_space);
+		printf("  - requested free space: %lu\n", (unsigned long)size);
+		printf("  - current free space: %lu\n", (unsigned long)free_space);
 		#endif
 		return NULL;
 	}
 
-	memcpy(ptr, addr, size);
+	memcpy(ptr, addr, (size < old) ? size : old);
 	pool_free(addr);
 
 	return ptr;
 }
 
-// Search for a free space to place a new block
-static inline void * get_loc_to_place(void * current, unsigned int size) {
+// Checks a free block can store size bytes, size register included. malloc() forks it if the
+// remainder can be a free block, else consumes it
+static inline int blk_fits(blk_t * blk, pool_size_t size) {
+	return blk_size(blk) + reg_size >= size;
+}
+
+
+// -----------------------------------------------------------------------------------------------
+// Search for a free space to place a new block, following the placement policy:
+//  - next-fit: starts from the current free block, parses the prv blocks then the nxt ones
+//  - first-fit: selects the free block wide enough with the lowest address, the first one of
+//    the list, or the whole list is parsed with the boundary tags, the list being unordered
+//  - best-fit: parses all the free blocks to select the narrowest one
+//  - worst-fit: parses all the free blocks to select the widest one
+//
+// Argument:
+//  - current: the current free block
+//  - size: the number of bytes to carve, size register included
+// Returns:
+//  - the free block to fork, NULL if none is wide enough
+// -----------------------------------------------------------------------------------------------
+static inline void * get_loc_to_place(void * current, pool_size_t size) {
 
 	blk_t * parse = current;
 	blk_t * org = current;
+	blk_t * sel = NULL;
 
-	// Current block is wide enough
-	if (org->size >= size && parse->size-size > header_size)
-		return current;
+	// All the free space is allocated
+	if (parse == NULL)
+		return NULL;
 
-	// If not, parse the prv blocks to find a place
-	parse = current;
-	parse = parse->prv;
-	while (parse != NULL) {
-		if (parse->size >= size && parse->size-size > header_size)
-			return (void *)parse;
-		parse = parse->prv;
-	}
+	if (pool_policy == POOL_FIT_NEXT) {
 
-	// If not, parse the nxt blocks to find a place
-	parse = current;
-	parse = parse->nxt;
-	while (parse != NULL) {
-		if (parse->size >= size && parse->size-size > header_size)
-			return (void *)parse;
-		parse = parse->nxt;
-	}
+		// Current block is wide enough
+		if (blk_fits(org, size))
+			return current;
 
-	// No space found, give up and stop the allocation
-	#ifdef POOL_ARENA_DEBUG
-	printf("ERROR: Failed to allocate the chunk\n");
+		// If not, parse the prv blocks to find a place
+		parse = current;
+		parse = blk_ptr(parse->prv);
+		while (parse != NULL) {
+			if (blk_fits(parse, size))
+				return (void *)parse;
+			parse = blk_ptr(parse->prv);
+		}
+
+		// If not, parse the nxt blocks to find a place
+		parse = current;
+		parse = blk_ptr(parse->nxt);
+		while (parse != NULL) {
+			if (blk_fits(parse, size))
+				return (void *)parse;
+			parse = blk_ptr(parse->nxt);
+		}
+
+	} else {
+
+		// Rewind the linked list to get the first free space block
+		while (blk_ptr(parse->prv) != NULL)
+			parse = blk_ptr(parse->prv);
+
+		while (parse != NULL) {
+			if (blk_fits(parse, size)) {
+				#if !POOL_ARENA_BTAG
+				if (pool_policy == POOL_FIT_FIRST)
+					return (void *)parse;
+				#endif
+				// With the boundary tags, the list isn't ordered by address: the whole list is
+				// parsed to select the lowest address for the first-fit
+				if (sel == NULL)
+					sel = parse;
+				else if (pool_policy == POOL_FIT_FIRST && parse < sel)
+					sel = parse;
+				else if (pool_policy == POOL_FIT_BEST && blk_size(parse) < blk_size(sel))
+					sel = parse;
+				else if (pool_policy == POOL_FIT_WORST && blk_size(parse) > blk_size(sel))
+					sel = parse;
+			}
+			parse = blk_ptr(parse->nxt);
+		}
+
+		if (sel != NULL)
+			return (void *)sel;
+	}
+
+	// No space found, give up and stop the allocation
+	#ifdef POOL_ARENA_DEBUG
+	printf("ERROR: Failed to allocate the chunk\n");
+	#endif
+
+	return NULL;
+}
+
+
+// -----------------------------------------------------------------------------------------------
+// Search for a free space from one end of the arena: the block wide enough with the lowest
+// address for a small block, with the highest address for a large one. The linked list is
+// ordered by address, so it's parsed from its head or from its tail. With the boundary tags,
+// it's not, so the whole list is parsed.
+//
+// Argument:
+//  - current: the current free block
+//  - size: the number of bytes to carve, size register included
+//  - high: select the block with the highest address instead of the lowest one
+// Returns:
+//  - the free block to fork, NULL if none is wide enough
+// -----------------------------------------------------------------------------------------------
+static inline void * get_end_to_place(void * current, pool_size_t size, int high) {
+
+	blk_t * parse = current;
+	blk_t * sel = NULL;
+
+	// All the free space is allocated
+	if (parse == NULL)
+		return NULL;
+
+	// Rewind the linked list to get the first free space block
+	while (blk_ptr(parse->prv) != NULL)
+		parse = blk_ptr(parse->prv);
+
+	#if POOL_ARENA_BTAG
+	while (parse != NULL) {
+		if (blk_fits(parse, size) && (sel == NULL || (high ? parse > sel : parse < sel)))
+			sel = parse;
+		parse = blk_ptr(parse->nxt);
+	}
+	#else
+	if (high) {
+		while (blk_ptr(parse->nxt) != NULL)
+			parse = blk_ptr(parse->nxt);
+	}
+	while (parse != NULL && sel == NULL) {
+		if (blk_fits(parse, size))
+			sel = parse;
+		parse = high ? blk_ptr(parse->prv) : blk_ptr(parse->nxt);
+	}
+	#endif
+
+	#ifdef POOL_ARENA_DEBUG
+	if (sel == NULL)
+		printf("ERROR: Failed to allocate the chunk\n");
+	#endif
+
+	return (void *)sel;
+}
+
+
+// -----------------------------------------------------------------------------------------------
+// Computes the size class of a block: the power of two of the size, refined by the next
+// LOG2_SUB_CLASS bits. So with 4 sub-classes, 256 up to 319 bytes fall in the same class,
+// 320 up to 383 in the next one...
+//
+// Argument:
+//  - size: the block's payload size
+// Returns:
+//  - the class index, between 0 and NB_CLASS-1
+// -----------------------------------------------------------------------------------------------
+static inline unsigned int size_class(pool_size_t size) {
+
+	unsigned int fl;
+	unsigned int sl;
+
+	if (size < NB_SUB_CLASS)
+		return size;
+
+	#if POOL_ARENA_WIDE
+	if (size >> 16 >> 16)
+		fl = 32 + find_last_set((unsigned int)(size >> 16 >> 16));
+	else
+	#endif
+	fl = find_last_set((unsigned int)size);
+	sl = (size >> (fl - LOG2_SUB_CLASS)) & (NB_SUB_CLASS - 1);
+
+	return fl * NB_SUB_CLASS + sl;
+}
+
+
+// Chain a free block on top of its size class list
+static inline void bin_insert(blk_t * blk) {
+
+	unsigned int cls = size_class(blk_size(blk));
+
+	blk->bin_prv = blk_link(NULL);
+	blk->bin_nxt = blk_link(bins[cls]);
+	if (bins[cls] != NULL)
+		bins[cls]->bin_prv = blk_link(blk);
+	bins[cls] = blk;
+	bin_map[cls / 32] |= 1u << (cls % 32);
+}
+
+
+// Unchain a free block from its size class list
+static inline void bin_remove(blk_t * blk) {
+
+	unsigned int cls = size_class(blk_size(blk));
+
+	if (blk_ptr(blk->bin_prv) != NULL)
+		blk_ptr(blk->bin_prv)->bin_nxt = blk->bin_nxt;
+	else
+		bins[cls] = blk_ptr(blk->bin_nxt);
+
+	if (blk_ptr(blk->bin_nxt) != NULL)
+		blk_ptr(blk->bin_nxt)->bin_prv = blk->bin_prv;
+
+	if (bins[cls] == NULL)
+		bin_map[cls / 32] &= ~(1u << (cls % 32));
+}
+
+
+// -----------------------------------------------------------------------------------------------
+// Search for a free space in segregated mode. The class of the smallest suitable block is
+// parsed first because its blocks may be a bit too small. If none fits, the first non-empty
+// higher class is selected with the bitmap: any of its blocks is wide enough.
+//
+// Argument:
+//  - size: the number of bytes to carve, size register included
+// Returns:
+//  - the free block to fork, NULL if none is wide enough
+// -----------------------------------------------------------------------------------------------
+static inline void * get_bin_to_place(pool_size_t size) {
+
+	// Same constraint than get_loc_to_place(): the payload must store
+	// the block without its size register
+	pool_size_t need = size - reg_size;
+	unsigned int cls = size_class(need);
+	unsigned int idx;
+	unsigned int map;
+	blk_t * parse;
+
+	for (parse = bins[cls]; parse != NULL; parse = blk_ptr(parse->bin_nxt)) {
+		if (blk_size(parse) >= need)
+			return (void *)parse;
+	}
+
+	// Jump to the next non-empty class
+	for (idx = (cls + 1) / 32; idx < NB_CLASS / 32; idx++) {
+		map = bin_map[idx];
+		// Mask the classes below the one requested
+		if (idx == (cls + 1) / 32)
+			map &= ~((1u << ((cls + 1) % 32)) - 1);
+		if (map != 0)
+			return (void *)bins[idx * 32 + find_first_set(map)];
+	}
+
+	#ifdef POOL_ARENA_DEBUG
+	printf("ERROR: Failed to allocate the chunk\n");
+	#endif
+
+	return NULL;
+}
+
+
+// Priority of a node in the tree, a hash of its address
+static inline unsigned int tree_prio(blk_t * blk) {
+	return (unsigned int)((size_t)blk / reg_size) * 2654435761u;
+}
+
+
+// Order of the tree: by size, then by address for the blocks of the same size
+static inline int tree_less(blk_t * a, blk_t * b) {
+	return blk_size(a) < blk_size(b) || (blk_size(a) == blk_size(b) && a < b);
+}
+
+
+// -----------------------------------------------------------------------------------------------
+// Inserts a free block in a sub-tree: the block is placed as a leaf following the order, then
+// rotated up as long as its priority is higher than its parent's one
+//
+// Arguments:
+//  - root: the root of the sub-tree
+//  - blk: the free block to insert
+// Returns:
+//  - the new root of the sub-tree
+// -----------------------------------------------------------------------------------------------
+static blk_t * tree_insert(blk_t * root, blk_t * blk) {
+
+	blk_t * child;
+
+	if (root == NULL) {
+		blk->left = blk_link(NULL);
+		blk->right = blk_link(NULL);
+		return blk;
+	}
+
+	if (tree_less(blk, root)) {
+		root->left = blk_link(tree_insert(blk_ptr(root->left), blk));
+		if (tree_prio(blk_ptr(root->left)) > tree_prio(root)) {
+			child = blk_ptr(root->left);
+			root->left = child->right;
+			child->right = blk_link(root);
+			return child;
+		}
+	} else {
+		root->right = blk_link(tree_insert(blk_ptr(root->right), blk));
+		if (tree_prio(blk_ptr(root->right)) > tree_prio(root)) {
+			child = blk_ptr(root->right);
+			root->right = child->left;
+			child->left = blk_link(root);
+			return child;
+		}
+	}
+
+	return root;
+}
+
+
+// Joins two sub-trees, all the blocks of a being lower than the ones of b
+static blk_t * tree_join(blk_t * a, blk_t * b) {
+
+	if (a == NULL)
+		return b;
+	if (b == NULL)
+		return a;
+
+	if (tree_prio(a) > tree_prio(b)) {
+		a->right = blk_link(tree_join(blk_ptr(a->right), b));
+		return a;
+	}
+	b->left = blk_link(tree_join(a, blk_ptr(b->left)));
+	return b;
+}
+
+
+// -----------------------------------------------------------------------------------------------
+// Removes a free block from a sub-tree, its children being joined in its place
+//
+// Arguments:
+//  - root: the root of the sub-tree
+//  - blk: the free block to remove
+// Returns:
+//  - the new root of the sub-tree
+// -----------------------------------------------------------------------------------------------
+static blk_t * tree_remove(blk_t * root, blk_t * blk) {
+
+	if (root == NULL)
+		return NULL;
+	if (root == blk)
+		return tree_join(blk_ptr(root->left), blk_ptr(root->right));
+
+	if (tree_less(blk, root))
+		root->left = blk_link(tree_remove(blk_ptr(root->left), blk));
+	else
+		root->right = blk_link(tree_remove(blk_ptr(root->right), blk));
+
+	return root;
+}
+
+
+// -----------------------------------------------------------------------------------------------
+// Search for a free space in tree mode: the narrowest block wide enough, so a best-fit in
+// O(log n)
+//
+// Argument:
+//  - size: the number of bytes to carve, size register included
+// Returns:
+//  - the free block to fork, NULL if none is wide enough
+// -----------------------------------------------------------------------------------------------
+static inline void * get_tree_to_place(pool_size_t size) {
+
+	// Same constraint than get_loc_to_place()
+	pool_size_t need = size - reg_size;
+	blk_t * parse = tree_root;
+	blk_t * sel = NULL;
+
+	while (parse != NULL) {
+		if (blk_size(parse) >= need) {
+			sel = parse;
+			parse = blk_ptr(parse->left);
+		} else {
+			parse = blk_ptr(parse->right);
+		}
+	}
+
+	#ifdef POOL_ARENA_DEBUG
+	if (sel == NULL)
+		printf("ERROR: Failed to allocate the chunk\n");
 	#endif
 
-	return NULL;
+	return (void *)sel;
+}
+
+
+// -----------------------------------------------------------------------------------------------
+// Walks a sub-tree to check the blocks are ordered between lo and hi and a child's priority is
+// never higher than its parent's one
+//
+// Arguments:
+//  - node: the root of the sub-tree
+//  - lo/hi: the blocks bounding the sub-tree, NULL if unbounded
+//  - space: accumulates the free space of the sub-tree
+//  - err: set to 1 if the sub-tree is corrupted
+// Returns:
+//  - the number of blocks of the sub-tree
+// -----------------------------------------------------------------------------------------------
+static pool_size_t tree_check(blk_t * node, blk_t * lo, blk_t * hi, pool_size_t * space,
+							  int * err) {
+
+	if (node == NULL)
+		return 0;
+
+	if ((lo != NULL && !tree_less(lo, node)) || (hi != NULL && !tree_less(node, hi)))
+		*err = 1;
+	if ((blk_ptr(node->left) != NULL && tree_prio(blk_ptr(node->left)) > tree_prio(node)) ||
+		(blk_ptr(node->right) != NULL && tree_prio(blk_ptr(node->right)) > tree_prio(node)))
+		*err = 1;
+
+	*space += blk_size(node);
+
+	return 1 + tree_check(blk_ptr(node->left), lo, node, space, err)
+			 + tree_check(blk_ptr(node->right), node, hi, space, err);
+}
+
+
+// Prints a sub-tree in order, indented by depth
+static void tree_log(blk_t * node, int depth) {
+
+	if (node == NULL)
+		return;
+
+	tree_log(blk_ptr(node->left), depth + 1);
+	printf("%*s%p (%lu)\n", 2 * depth, "", (void *)node, (unsigned long)blk_size(node));
+	tree_log(blk_ptr(node->right), depth + 1);
+}
+
+
+// -----------------------------------------------------------------------------------------------
+// Finds the first entry of the SoA side arrays whose size is at least need. The sizes are
+// contiguous, so they are compared 8 (AVX2) or 4 (SSE2) at once. The sizes are unsigned but
+// the SIMD comparison is signed, so both operands are biased by 2^31.
+//
+// Argument:
+//  - need: the minimum size of the block
+// Returns:
+//  - the entry index, soa_cnt if none is wide enough
+// -----------------------------------------------------------------------------------------------
+static inline pool_size_t soa_scan(pool_size_t need) {
+
+	pool_size_t i = 0;
+
+	#if POOL_ARENA_WIDE
+	// The wide sizes don't fit the 32 bits lanes
+	#elif defined(__AVX2__)
+	__m256i bias = _mm256_set1_epi32((int)0x80000000u);
+	__m256i key = _mm256_set1_epi32((int)((need - 1) ^ 0x80000000u));
+	__m256i lanes;
+	unsigned int mask;
+
+	for (; i + 8 <= soa_cnt; i += 8) {
+		lanes = _mm256_xor_si256(_mm256_loadu_si256((const __m256i *)&soa_len[i]), bias);
+		mask = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(lanes, key)));
+		if (mask != 0)
+			return i + find_first_set(mask);
+	}
+	#elif defined(__SSE2__)
+	__m128i bias = _mm_set1_epi32((int)0x80000000u);
+	__m128i key = _mm_set1_epi32((int)((need - 1) ^ 0x80000000u));
+	__m128i lanes;
+	unsigned int mask;
+
+	for (; i + 4 <= soa_cnt; i += 4) {
+		lanes = _mm_xor_si128(_mm_loadu_si128((const __m128i *)&soa_len[i]), bias);
+		mask = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(lanes, key)));
+		if (mask != 0)
+			return i + find_first_set(mask);
+	}
+	#endif
+
+	// Remaining entries, or all of them without SIMD
+	for (; i < soa_cnt; i++) {
+		if (soa_len[i] >= need)
+			return i;
+	}
+
+	return soa_cnt;
+}
+
+
+// Binary search of the first entry of the SoA side arrays whose address is not lower than blk
+static inline pool_size_t soa_search(void * blk) {
+
+	pool_size_t off = (char *)blk - (char *)pool_addr;
+	pool_size_t lo = 0;
+	pool_size_t hi = soa_cnt;
+	pool_size_t mid;
+
+	while (lo < hi) {
+		mid = lo + (hi - lo) / 2;
+		if (soa_off[mid] < off)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	return lo;
+}
+
+
+// -----------------------------------------------------------------------------------------------
+// Search for a free space in SoA mode: a first-fit by address, scanning the sizes array
+// instead of the linked list. From the high end, the sizes are scanned backward.
+//
+// Argument:
+//  - size: the number of bytes to carve, size register included
+//  - high: select the block with the highest address instead of the lowest one
+// Returns:
+//  - the free block to fork, NULL if none is wide enough
+// -----------------------------------------------------------------------------------------------
+static inline void * get_soa_to_place(pool_size_t size, int high) {
+
+	// Same constraint than get_loc_to_place()
+	pool_size_t need = size - reg_size;
+
+	if (high) {
+		for (soa_slot = soa_cnt; soa_slot > 0; soa_slot--) {
+			if (soa_len[soa_slot - 1] >= need)
+				break;
+		}
+		soa_slot = (soa_slot == 0) ? soa_cnt : soa_slot - 1;
+	} else {
+		soa_slot = soa_scan(need);
+	}
+
+	if (soa_slot == soa_cnt) {
+		#ifdef POOL_ARENA_DEBUG
+		printf("ERROR: Failed to allocate the chunk\n");
+		#endif
+		return NULL;
+	}
+
+	return (char *)pool_addr + soa_off[soa_slot];
+}
+
+
+// Insert a free block in the SoA side arrays, keeping them sorted by address
+static inline void soa_insert(blk_t * blk) {
+
+	pool_size_t idx = soa_search(blk);
+
+	memmove(&soa_off[idx + 1], &soa_off[idx], (soa_cnt - idx) * sizeof(pool_size_t));
+	memmove(&soa_len[idx + 1], &soa_len[idx], (soa_cnt - idx) * sizeof(pool_size_t));
+	soa_off[idx] = (char *)blk - (char *)pool_addr;
+	soa_len[idx] = blk_size(blk);
+	soa_cnt += 1;
+}
+
+
+// Remove a free block from the SoA side arrays
+static inline void soa_remove(blk_t * blk) {
+
+	pool_size_t idx = soa_search(blk);
+	pool_size_t nb;
+
+	// Only the entries after the block are shifted, none if it's the last one
+	if (idx + 1 < soa_cnt) {
+		nb = soa_cnt - idx - 1;
+		memmove(&soa_off[idx], &soa_off[idx + 1], nb * sizeof(pool_size_t));
+		memmove(&soa_len[idx], &soa_len[idx + 1], nb * sizeof(pool_size_t));
+	}
+	soa_cnt -= 1;
+}
+
+
+// Chain a free block in the index of the segregated, tree or SoA mode
+static inline void index_insert(blk_t * blk) {
+	if (pool_mode == POOL_MODE_SEGREGATED)
+		bin_insert(blk);
+	else if (pool_mode == POOL_MODE_TREE)
+		tree_root = tree_insert(tree_root, blk);
+	else if (pool_mode == POOL_MODE_SOA)
+		soa_insert(blk);
+}
+
+
+// Unchain a free block from the index of the segregated, tree or SoA mode
+static inline void index_remove(blk_t * blk) {
+	if (pool_mode == POOL_MODE_SEGREGATED)
+		bin_remove(blk);
+	else if (pool_mode == POOL_MODE_TREE)
+		tree_root = tree_remove(tree_root, blk);
+	else if (pool_mode == POOL_MODE_SOA)
+		soa_remove(blk);
+}
+
+
+// -----------------------------------------------------------------------------------------------
+// Parses the free blocks to find the place to set the one under release
+// Useful to update the linked list correctly and fast its parsing.
+//
+// Follows the different cases to handle:
+//
+// ┌───────┬────────────────────────────────────────────┐
+// │Block 0│          ~~~~~~~~ Free ~~~~~~~~~           │
+// └───────┴────────────────────────────────────────────┘
+// ┌────────────────────────────────────────────┬───────┐
+// │          ~~~~~~~~ Free ~~~~~~~~~           │Block 0│
+// └────────────────────────────────────────────┴───────┘
+// ┌───────────────┬───────┬───────────────────────────┐
+// │ ~~~ Free ~~~  │Block 0│  ~~~~~~~~ Free ~~~~~~~~   │
+// └───────────────┴───────┴───────────────────────────┘
+// ┌───────┬────────────────────────────────────┬───────┐
+// │Block 0│      ~~~~~~~~ Free ~~~~~~~~~       │Block 1│
+// └───────┴────────────────────────────────────┴───────┘
+// ┌───────┬───────┬────────────────────┬───────┬────────┬───────┬───────┐
+// │Block 0│Block 1│   ~~~ Free ~~~     │Block 2│~ Free ~│Block 3│Block 4│
+// └───────┴───────┴────────────────────┴───────┴────────┴───────┴───────┘
+// ┌────────┬───────┬───────┬────────────────────┬───────┬────────┐
+// │~ Free ~│Block 0│Block 1│   ~~~ Free ~~~     │Block 2│~ Free ~│
+// └────────┴───────┴───────┴────────────────────┴───────┴────────┘
+//
+// Argument:
+//  - addr: pointer to an address to release
+// Returns:
+//  - a pointer to the location where to place the block to release. The place to use can be on the
+//    left or on the right of address passed. If no place found, returns NULL
+//
+// -----------------------------------------------------------------------------------------------
+static inline void * get_loc_to_free(void * addr) {
+
+	pool_size_t idx;
+
+	// The side arrays are sorted by address: the neighbors are found by a binary search
+	// instead of parsing the linked list
+	if (pool_mode == POOL_MODE_SOA) {
+		if (soa_cnt == 0)
+			return NULL;
+		idx = soa_search(addr);
+		if (idx == soa_cnt)
+			idx -= 1;
+		return (char *)pool_addr + soa_off[idx];
+	}
+
+	// All the free space is allocated, the block will be the only free one
+	if (current == NULL)
+		return NULL;
+
+	// In case the free block is monolithic, just return its address
+	if (blk_ptr(current->prv) == NULL && blk_ptr(current->nxt) == NULL) {
+		#ifdef POOL_ARENA_DEBUG
+		printf("  - no prv or nxt pointers\n");
+		#endif
+		return (void *)(current);
+	}
+
+    // The current block of free space manipulated by the library
+    tmp_pt = (blk_t *)(current);
+    tmp_blk = tmp_pt;
+
+	// Location found to place the bloc under release
+    void * loc = NULL;
+
+    // The list is ordered by address, so we can divide the parsing to select
+    // directly the right direction
+    if (addr < tmp_pt) {
+        while (1) {
+			loc = (blk_t *)(tmp_blk);
+			// No more free space on smaller address range, so when
+			// can place this block on left of the current tmp / current free space
+			if (blk_ptr(tmp_blk->prv) == NULL) {
+				break;
+			}
+			// Next free block has a smaller address, so we are place
+			// between two blocks: free.prv < data block < tmp / currrent free space
+			else if (addr > (void *)blk_ptr(tmp_blk->prv)) {
+				break;
+			}
+			tmp_blk = blk_ptr(tmp_blk->prv);
+        }
+    } else {
+        while (1) {
+			loc = (blk_t *)(tmp_blk);
+			// No more free space on higher address range, so when
+			// can place this block on right of the current tmp / current free space
+			if (blk_ptr(tmp_blk->nxt) == NULL) {
+				break;
+			}
+			// Next free block has a higher address, so we are place
+			// between two blocks: free.prv < data block < tmp / currrent free space
+			else if (addr < (void *)blk_ptr(tmp_blk->nxt)) {
+				break;
+			}
+			tmp_blk = blk_ptr(tmp_blk->nxt);
+        }
+    }
+
+    return loc;
+}
+
+
+// Chains a released block in a cache list, the block still flagged in use
+static inline void cache_push(blk_t ** bin, blk_t * blk) {
+
+	blk->nxt = blk_link(*bin);
+	*bin = blk;
+	nb_alloc_blk -= 1;
+	alloc_space -= blk_size(blk);
+	nb_quick_blk += 1;
+	quick_space += blk_size(blk);
+}
+
+
+// Unchains the head of a non-empty cache list, accounted back as allocated
+static inline blk_t * cache_pop(blk_t ** bin) {
+
+	blk_t * blk = *bin;
+
+	*bin = blk_ptr(blk->nxt);
+	nb_quick_blk -= 1;
+	quick_space -= blk_size(blk);
+	nb_alloc_blk += 1;
+	alloc_space += blk_size(blk);
+	return blk;
+}
+
+
+// Caches a released block in its quick bin, returns 0 if too wide to be cached
+static inline int quick_push(blk_t * blk) {
+
+	unsigned int idx = blk_size(blk) / reg_size;
+
+	if (idx >= NB_QUICK)
+		return 0;
+
+	#ifdef POOL_ARENA_DEBUG
+	printf("  - cached in quick bin %d\n", idx);
+	#endif
+
+	cache_push(&quick_bins[idx], blk);
+	return 1;
+}
+
+
+// Takes back the last block cached for a payload size, NULL if none
+static inline void * quick_pop(pool_size_t payload) {
+
+	unsigned int idx = payload / reg_size;
+	blk_t * blk;
+
+	if (idx >= NB_QUICK || quick_bins[idx] == NULL)
+		return NULL;
+
+	blk = cache_pop(&quick_bins[idx]);
+
+	#ifdef POOL_ARENA_DEBUG
+	printf("  - reused from quick bin %d: %p\n", idx, (void *)blk);
+	printf("------------------------------------------------------------------------\n");
+	#endif
+
+	return (char *)blk + reg_size;
+}
+
+
+// Caches a released block in the list of its size if hot, returns 0 otherwise
+static inline int hot_push(blk_t * blk) {
+
+	for (unsigned int slot = 0; slot < NB_HOT; slot++) {
+		if (hot_size[slot] != 0 && hot_size[slot] == blk_size(blk)) {
+			#ifdef POOL_ARENA_DEBUG
+			printf("  - cached in hot list %d\n", slot);
+			#endif
+			cache_push(&hot_bins[slot], blk);
+			return 1;
+		}
+	}
+	return 0;
+}
+
+
+// Takes back the last block cached for a hot payload size, NULL if none
+static inline void * hot_pop(pool_size_t payload) {
+
+	blk_t * blk;
+
+	for (unsigned int slot = 0; slot < NB_HOT; slot++) {
+		if (hot_size[slot] == payload && hot_bins[slot] != NULL) {
+			blk = cache_pop(&hot_bins[slot]);
+			#ifdef POOL_ARENA_DEBUG
+			printf("  - reused from hot list %d: %p\n", slot, (void *)blk);
+			printf("------------------------------------------------------------------------\n");
+			#endif
+			return (char *)blk + reg_size;
+		}
+	}
+	return NULL;
+}
+
+
+// Takes back the last block released in the zone of a payload size, NULL if none
+static inline void * zone_pop(pool_size_t payload) {
+
+	blk_t * blk;
+
+	for (unsigned int z = 0; z < nb_zone; z++) {
+		if (zone_size[z] == payload) {
+			if (zone_bins[z] == NULL)
+				return NULL;
+			blk = cache_pop(&zone_bins[z]);
+			#ifdef POOL_ARENA_DEBUG
+			printf("  - reused from zone %d: %p\n", z, (void *)blk);
+			printf("------------------------------------------------------------------------\n");
+			#endif
+			return (char *)blk + reg_size;
+		}
+	}
+	return NULL;
+}
+
+
+// Caches a released block back in its zone, returns 0 if it belongs to none
+static inline int zone_push(blk_t * blk) {
+
+	for (unsigned int z = 0; z < nb_zone; z++) {
+		if ((char *)blk >= zone_lo[z] && (char *)blk < zone_hi[z]) {
+			#ifdef POOL_ARENA_DEBUG
+			printf("  - cached in zone %d\n", z);
+			#endif
+			cache_push(&zone_bins[z], blk);
+			return 1;
+		}
+	}
+	return 0;
+}
+
+
+// -----------------------------------------------------------------------------------------------
+// Elects the NB_HOT most requested sizes of the histogram, releases the lists of the sizes no
+// longer hot, then halves the counts so the old traffic fades out
+// -----------------------------------------------------------------------------------------------
+static void adapt_update(void) {
+
+	unsigned int hot[NB_HOT] = {0};
+	unsigned int count[NB_HOT];
+	unsigned int best;
+	unsigned int slot;
+	unsigned int idx;
+	blk_t * blk;
+
+	// The sizes are elected by decreasing count, the smallest first on a tie
+	for (slot = 0; slot < NB_HOT; slot++) {
+		best = 0;
+		for (idx = 1; idx < NB_ADAPT; idx++) {
+			if (adapt_hist[idx] > adapt_hist[best])
+				best = idx;
+		}
+		if (adapt_hist[best] == 0)
+			break;
+		hot[slot] = best * reg_size;
+		count[slot] = adapt_hist[best];
+		adapt_hist[best] = 0;
+	}
+	for (idx = 0; idx < slot; idx++)
+		adapt_hist[hot[idx] / reg_size] = count[idx];
+
+	// The sizes still hot keep their list, the others are released
+	for (slot = 0; slot < NB_HOT; slot++) {
+		for (idx = 0; idx < NB_HOT; idx++) {
+			if (hot_size[slot] != 0 && hot[idx] == hot_size[slot]) {
+				hot[idx] = 0;
+				break;
+			}
+		}
+		if (idx < NB_HOT)
+			continue;
+		while (hot_bins[slot] != NULL) {
+			blk = cache_pop(&hot_bins[slot]);
+			blk_release((char *)blk + reg_size);
+		}
+		hot_size[slot] = 0;
+	}
+
+	// The new hot sizes take the free slots
+	for (idx = 0; idx < NB_HOT; idx++) {
+		for (slot = 0; hot[idx] != 0 && slot < NB_HOT; slot++) {
+			if (hot_size[slot] == 0) {
+				hot_size[slot] = hot[idx];
+				break;
+			}
+		}
+	}
+
+	#ifdef POOL_ARENA_DEBUG
+	printf("  - hot sizes:");
+	for (idx = 0; idx < NB_HOT; idx++)
+		printf(" %lu", (unsigned long)hot_size[idx]);
+	printf("\n");
+	#endif
+
+	for (idx = 0; idx < NB_ADAPT; idx++)
+		adapt_hist[idx] /= 2;
+	adapt_cnt = 0;
+}
+
+
+// -----------------------------------------------------------------------------------------------
+// Releases all the blocks cached in the quick bins and the hot lists, merging them with their
+// free neighbors
+//
+// Arguments:
+//	- None
+// Returns:
+// 	- the number of blocks released
+// -----------------------------------------------------------------------------------------------
+int pool_consolidate(void) {
+
+	int cnt = 0;
+	blk_t * blk;
+
+	if (engine != NULL)
+		return 0;
+
+	for (unsigned int idx = 0; idx < NB_QUICK; idx++) {
+		while (quick_bins[idx] != NULL) {
+			blk = cache_pop(&quick_bins[idx]);
+			blk_release((char *)blk + reg_size);
+			cnt += 1;
+		}
+	}
+
+	for (unsigned int slot = 0; slot < NB_HOT; slot++) {
+		while (hot_bins[slot] != NULL) {
+			blk = cache_pop(&hot_bins[slot]);
+			blk_release((char *)blk + reg_size);
+			cnt += 1;
+		}
+	}
+
+	return cnt;
+}
+
+
+// -----------------------------------------------------------------------------------------------
+// Opens a scope. The outermost scope carves a region of size bytes from the arena, then until the
+// scope ends, pool_malloc() bumps a pointer in the region and pool_free() doesn't release
+// anything. A nested scope marks the region's top, its blocks are bumped after the mark
+//
+// Arguments:
+//	- size: the number of bytes of the region, ignored by the nested scopes
+// Returns:
+// 	- 0 if the scope is open, -1 if the region can't be carved or too many scopes are open
+// -----------------------------------------------------------------------------------------------
+int pool_scope_begin(pool_size_t size) {
+
+	if (nb_scope >= POOL_ARENA_SCOPES)
+		return -1;
+
+	if (nb_scope == 0) {
+		scope_lo = pool_malloc(size);
+		if (scope_lo == NULL)
+			return -1;
+		scope_hi = scope_lo + pool_get_size(scope_lo);
+		scope_top = scope_lo;
+	}
+	scope_mark[nb_scope++] = scope_top;
+
+	#ifdef POOL_ARENA_DEBUG
+	printf("  - scope %d open, region top: %p\n", nb_scope, (void *)scope_top);
+	#endif
+
+	return 0;
+}
+
+
+// -----------------------------------------------------------------------------------------------
+// Closes the innermost scope: all the blocks allocated since it began are reclaimed at once,
+// whatever their number. The outermost scope releases its region in the arena
+//
+// Arguments:
+//	- None
+// Returns:
+// 	- 0 if a scope was open, -1 otherwise
+// -----------------------------------------------------------------------------------------------
+int pool_scope_end(void) {
+
+	if (nb_scope == 0)
+		return -1;
+
+	scope_top = scope_mark[--nb_scope];
+	if (nb_scope == 0)
+		return pool_free(scope_lo);
+
+	return 0;
+}
+
+
+// Checks a block belongs to the region of the scopes, the pool_free() of its blocks being ignored
+static inline int scope_owns(void * addr) {
+	return nb_scope > 0 && (char *)addr > scope_lo && (char *)addr < scope_hi;
+}
+
+
+// Bumps a block in the region of the scopes: a size register then the payload, so the block has
+// the size pool_malloc() would give it, its payload aligned on align bytes
+static inline void * scope_bump(pool_size_t size, pool_size_t align) {
+
+	// The payload is moved forward to its alignment, the padding is reclaimed with the scope
+	pool_size_t pad = (align - ((size_t)scope_top + reg_size) % align) % align;
+	blk_t * blk = (blk_t *)(scope_top + pad);
+	pool_size_t payload = round_up(&size);
+
+	if (size == 0 || payload < size ||
+		(pool_size_t)(scope_hi - scope_top) < pad + payload + reg_size) {
+		#ifdef POOL_ARENA_DEBUG
+		printf("ERROR: Can't bump a %lu bytes block in the scope\n", (unsigned long)size);
+		#endif
+		return NULL;
+	}
+
+	blk->size = payload | BLK_INUSE | BLK_PINUSE;
+	scope_top += pad + reg_size + payload;
+
+	return (char *)blk + reg_size;
 }
 
 
 // -----------------------------------------------------------------------------------------------
-// Parses the free blocks to find the place to set the one under release
-// Useful to update the linked list correctly and fast its parsing.
-//
-// Follows the different cases to handle:
-//
-// ┌───────┬────────────────────────────────────────────┐
-// │Block 0│          ~~~~~~~~ Free ~~~~~~~~~           │
-// └───────┴────────────────────────────────────────────┘
-// ┌────────────────────────────────────────────┬───────┐
-// │          ~~~~~~~~ Free ~~~~~~~~~           │Block 0│
-// └────────────────────────────────────────────┴───────┘
-// ┌───────────────┬───────┬───────────────────────────┐
-// │ ~~~ Free ~~~  │Block 0│  ~~~~~~~~ Free ~~~~~~~~   │
-// └───────────────┴───────┴───────────────────────────┘
-// ┌───────┬────────────────────────────────────┬───────┐
-// │Block 0│      ~~~~~~~~ Free ~~~~~~~~~       │Block 1│
-// └───────┴────────────────────────────────────┴───────┘
-// ┌───────┬───────┬────────────────────┬───────┬────────┬───────┬───────┐
-// │Block 0│Block 1│   ~~~ Free ~~~     │Block 2│~ Free ~│Block 3│Block 4│
-// └───────┴───────┴────────────────────┴───────┴────────┴───────┴───────┘
-// ┌────────┬───────┬───────┬────────────────────┬───────┬────────┐
-// │~ Free ~│Block 0│Block 1│   ~~~ Free ~~~     │Block 2│~ Free ~│
-// └────────┴───────┴───────┴────────────────────┴───────┴────────┘
+// Drops all the blocks, the scopes and the caches: the arena gets back the state of the last
+// pool_init_mode() (or pool_init()), without parsing its content. The zones of pool_init_zones()
+// are carved again, all their blocks free
 //
-// Argument:
-//  - addr: pointer to an address to release
+// Arguments:
+//	- None
 // Returns:
-//  - a pointer to the location where to place the block to release. The place to use can be on the
-//    left or on the right of address passed. If no place found, returns NULL
-//
+// 	- 0 if the arena has been reset, -1 if no arena was setup
 // -----------------------------------------------------------------------------------------------
-static inline void * get_loc_to_free(void * addr) {
+int pool_reset(void) {
 
-	// In case the free block is monolithic, just return its address
-	if (current->prv == NULL && current->nxt == NULL) {
-		#ifdef POOL_ARENA_DEBUG
-		printf("  - no prv or nxt pointers\n");
-		#endif
-		return (void *)(current);
-	}
+	if (init_nb_zone > 0)
+		return pool_init_zones(init_addr, init_size, init_zones, init_nb_zone);
 
-    // The current block of free space manipulated by the library
-    tmp_pt = (blk_t *)(current);
-    tmp_blk = tmp_pt;
+	return pool_init_mode(init_addr, init_size, init_mode);
+}
 
-	// Location found to place the bloc under release
-    void * loc = NULL;
 
-    // The list is ordered by address, so we can divide the parsing to select
-    // directly the right direction
-    if (addr < tmp_pt) {
-        while (1) {
-			loc = (blk_t *)(tmp_blk);
-			// No more free space on smaller address range, so when
-			// can place this block on left of the current tmp / current free space
-			if (tmp_blk->prv == NULL) {
-				break;
-			}
-			// Next free block has a smaller address, so we are place
-			// between two blocks: free.prv < data block < tmp / currrent free space
-			else if (addr > (void *)tmp_blk->prv) {
-				break;
-			}
-			tmp_blk = tmp_blk->prv;
-        }
-    } else {
-        while (1) {
-			loc = (blk_t *)(tmp_blk);
-			// No more free space on higher address range, so when
-			// can place this block on right of the current tmp / current free space
-			if (tmp_blk->nxt == NULL) {
-				break;
-			}
-			// Next free block has a higher address, so we are place
-			// between two blocks: free.prv < data block < tmp / currrent free space
-			else if (addr < (void *)tmp_blk->nxt) {
-				break;
-			}
-			tmp_blk = tmp_blk->nxt;
-        }
-    }
+// Clears the lifetime hint of a block released, no longer accounted
+static inline void hint_clear(blk_t * blk) {
 
-    return loc;
+	int idx;
+
+	if (blk->size & BLK_HINTS) {
+		idx = (blk->size & BLK_LONG) ? 1 : 0;
+		nb_hint_blk[idx] -= 1;
+		hint_space[idx] -= blk_size(blk);
+		blk->size &= ~BLK_HINTS;
+	}
 }
 
 
@@ -446,12 +2265,119 @@ static inline void * get_loc_to_free(void * addr) {
 // -----------------------------------------------------------------------------------------------
 int pool_free(void * addr) {
 
+	blk_t * blk;
+
 	#ifdef POOL_ARENA_DEBUG
 	printf("------------------------------------------------------------------------\n");
     printf("Pool Free\n");
 	printf("------------------------------------------------------------------------\n");
 	#endif
 
+	// The blocks of a scope are reclaimed all at once when it ends
+	if (scope_owns(addr))
+		return 0;
+
+	if (engine != NULL)
+		return engine->release(addr);
+
+	// The block is no longer accounted with its lifetime hint
+	blk = (blk_t *)((char *)addr - reg_size);
+	hint_clear(blk);
+
+	// A block of a zone goes back to its zone
+	if (nb_zone > 0 && zone_push(blk))
+		return 0;
+
+	// A small block is cached in its quick bin, without merging
+	if ((pool_opts & POOL_OPT_QUICK) && quick_push((blk_t *)((char *)addr - reg_size)))
+		return 0;
+
+	// Same for a block of a hot size in adaptive mode
+	if ((pool_opts & POOL_OPT_ADAPT) && hot_push(blk))
+		return 0;
+
+	return blk_release(addr);
+}
+
+
+// Orders two blocks by address for pool_free_batch()
+static int ptr_cmp(const void * a, const void * b) {
+
+	char * x = *(char * const *)a;
+	char * y = *(char * const *)b;
+
+	return (x > y) - (x < y);
+}
+
+
+// -----------------------------------------------------------------------------------------------
+// Releases n blocks at once. The blocks are sorted by address, the contiguous ones are folded in
+// a single block, then each run is released in address order: the free space linked list is
+// parsed once forward for the whole batch, from the last block released to the next one.
+// The blocks are released in the free space, the quick bins and the hot lists are bypassed
+//
+// Arguments:
+//  - ptrs: the addresses of the blocks, sorted in place, the NULL ones being ignored
+//  - n: the number of addresses
+// Returns:
+//  - 0 if the blocks have been released, -1 otherwise
+// -----------------------------------------------------------------------------------------------
+int pool_free_batch(void ** ptrs, unsigned int n) {
+
+	blk_t * blk;
+	blk_t * run = NULL;
+	int ret = 0;
+
+	if (ptrs == NULL && n > 0)
+		return -1;
+
+	if (engine != NULL) {
+		for (unsigned int i = 0; i < n; i++) {
+			if (ptrs[i] != NULL && engine->release(ptrs[i]) != 0)
+				ret = -1;
+		}
+		return ret;
+	}
+
+	qsort(ptrs, n, sizeof(void *), ptr_cmp);
+
+	for (unsigned int i = 0; i < n; i++) {
+
+		if (ptrs[i] == NULL || scope_owns(ptrs[i]))
+			continue;
+		blk = (blk_t *)((char *)ptrs[i] - reg_size);
+		hint_clear(blk);
+		if (nb_zone > 0 && zone_push(blk))
+			continue;
+
+		// Contiguous with the run, the block is folded in it
+		if (run != NULL && (char *)run + blk_size(run) + reg_size == (char *)blk) {
+			run->size += blk_size(blk) + reg_size;
+			nb_alloc_blk -= 1;
+			alloc_space += reg_size;
+			continue;
+		}
+		if (run != NULL)
+			blk_release((char *)run + reg_size);
+		run = blk;
+	}
+	if (run != NULL)
+		blk_release((char *)run + reg_size);
+
+	return ret;
+}
+
+
+// -----------------------------------------------------------------------------------------------
+// Chains a released block back in the free space, merging it with its free neighbors
+//
+// Arguments:
+//  - addr: the address of the data block
+// Returns:
+//  - 0
+// -----------------------------------------------------------------------------------------------
+static int blk_release(void * addr) {
+
 	#ifdef POOL_ARENA_DEBUG
 	printf("  - current free block: %p\n", (void *)current);
 	printf("  - addr to free: %p\n", addr);
@@ -460,17 +2386,92 @@ int pool_free(void * addr) {
     // Get block info
     void * blk_pt = (char *)addr - reg_size;
     blk_t * blk = blk_pt;
-	blk->prv = NULL;
-	blk->nxt  = NULL;
+	blk->prv = blk_link(NULL);
+	blk->nxt = blk_link(NULL);
 
     // Update pool arena statistics
 	#ifdef POOL_ARENA_DEBUG
-	printf("  - size to free: %d\n", blk->size);
+	printf("  - size to free: %lu\n", (unsigned long)blk_size(blk));
 	#endif
 	nb_alloc_blk -= 1;
-	alloc_space -= blk->size;
+	alloc_space -= blk_size(blk);
 	nb_free_blk += 1;
-    free_space += blk->size;
+    free_space += blk_size(blk);
+
+	#if POOL_ARENA_BTAG
+
+	// With the boundary tags, the neighbors are reached directly. The block to release is
+	// chained in place of a free neighbor, or after the current free block if none
+
+	int linked = 0;
+	pool_size_t prv_size;
+	blk_t * nxt_blk = blk_next(blk);
+	blk_t * prv_blk;
+
+	// 1. Merge with the next block if free, taking its place in the linked list
+	if (nxt_blk != NULL && !(nxt_blk->size & BLK_INUSE)) {
+
+		#ifdef POOL_ARENA_DEBUG
+		printf("  - Merge nxt %p\n", (void *)nxt_blk);
+		#endif
+
+		index_remove(nxt_blk);
+		blk->prv = nxt_blk->prv;
+		blk->nxt = nxt_blk->nxt;
+		if (blk_ptr(blk->prv) != NULL)
+			blk_ptr(blk->prv)->nxt = blk_link(blk);
+		if (blk_ptr(blk->nxt) != NULL)
+			blk_ptr(blk->nxt)->prv = blk_link(blk);
+		blk->size += blk_size(nxt_blk) + reg_size;
+		linked = 1;
+		// Update pool's statistics
+		nb_free_blk -= 1;
+		free_space += reg_size;
+	}
+
+	// 2. Merge with the previous block if free, it absorbs the block to release
+	if (!(blk->size & BLK_PINUSE)) {
+
+		prv_size = *(pool_size_t *)((char *)blk - reg_size);
+		prv_blk = (blk_t *)((char *)blk - reg_size - prv_size);
+
+		#ifdef POOL_ARENA_DEBUG
+		printf("  - Merge prv %p\n", (void *)prv_blk);
+		#endif
+
+		index_remove(prv_blk);
+		// The block took the place of its next neighbor, unchain it
+		if (linked) {
+			if (blk_ptr(blk->prv) != NULL)
+				blk_ptr(blk->prv)->nxt = blk->nxt;
+			if (blk_ptr(blk->nxt) != NULL)
+				blk_ptr(blk->nxt)->prv = blk->prv;
+		}
+		prv_blk->size += blk_size(blk) + reg_size;
+		blk = prv_blk;
+		linked = 1;
+		// Update pool's statistics
+		nb_free_blk -= 1;
+		free_space += reg_size;
+	}
+
+	// 3. No free neighbor, chain the block after the current free block
+	if (!linked && current != NULL) {
+		blk->prv = blk_link(current);
+		blk->nxt = current->nxt;
+		if (blk_ptr(current->nxt) != NULL)
+			blk_ptr(current->nxt)->prv = blk_link(blk);
+		current->nxt = blk_link(blk);
+	}
+
+	// Tag the (maybe merged) block as free
+	blk->size &= ~BLK_INUSE;
+	blk_set_footer(blk);
+	nxt_blk = blk_next(blk);
+	if (nxt_blk != NULL)
+		nxt_blk->size &= ~BLK_PINUSE;
+
+	#else
 
 	// Free space zone to connect or merge with the block to release. Multiple
 	// free blocks are suitable to connect, this get_loc() ensuring we'll parse
@@ -484,47 +2485,50 @@ int pool_free(void * addr) {
 	#endif
 
 	// 1. Connect the block into the free space linked list
-	if (blk_pt<free_pt) {
-		blk->nxt = free_pt;
-		if (free_blk->prv != NULL) {
+	if (free_pt == NULL) {
+		// No other free block, nothing to link nor to merge
+	} else if (blk_pt<free_pt) {
+		blk->nxt = blk_link(free_pt);
+		if (blk_ptr(free_blk->prv) != NULL) {
 			blk->prv = free_blk->prv;
-			tmp_blk = (blk_t *)blk->prv;
-			tmp_blk->nxt = blk_pt;
+			tmp_blk = blk_ptr(blk->prv);
+			tmp_blk->nxt = blk_link(blk_pt);
 		}
-		free_blk->prv = blk_pt;
+		free_blk->prv = blk_link(blk_pt);
 	} else {
 
-		blk->prv = free_pt;
-		if (free_blk->nxt != NULL) {
+		blk->prv = blk_link(free_pt);
+		if (blk_ptr(free_blk->nxt) != NULL) {
 			blk->nxt = free_blk->nxt;
-			tmp_blk = (blk_t *)blk->nxt;
-			tmp_blk->prv = blk_pt;
+			tmp_blk = blk_ptr(blk->nxt);
+			tmp_blk->prv = blk_link(blk_pt);
 		}
-		free_blk->nxt = blk_pt;
+		free_blk->nxt = blk_link(blk_pt);
 	}
 
 	// Region is used to check if the block to release is adjacent to a free space
 	void * region;
 
     // 2. Try to merge with next block if exists
-    if (blk->nxt != NULL) {
+    if (blk_ptr(blk->nxt) != NULL) {
 
 		#ifdef POOL_ARENA_DEBUG
 		printf("  - Update nxt\n");
-		printf("  - %p\n", (void *)blk->nxt);
+		printf("  - %p\n", (void *)blk_ptr(blk->nxt));
 		#endif
 
-        region = (char *)blk_pt + blk->size + reg_size;
+        region = (char *)blk_pt + blk_size(blk) + reg_size;
         // if next block is contiguous the one to free, merge them
-        if (region == blk->nxt) {
+        if (region == blk_ptr(blk->nxt)) {
             // extend block size with nxt size
-            tmp_blk = (blk_t *)blk->nxt;
-            blk->size += tmp_blk->size + reg_size;
+            tmp_blk = blk_ptr(blk->nxt);
+			index_remove(tmp_blk);
+            blk->size += blk_size(tmp_blk) + reg_size;
 			blk->nxt = tmp_blk->nxt;
 			// link nxt->nxt block with the new block
-			if (blk->nxt != NULL) {
-				tmp_blk = (blk_t *)tmp_blk->nxt;
-				tmp_blk->prv = blk_pt;
+			if (blk_ptr(blk->nxt) != NULL) {
+				tmp_blk = blk_ptr(tmp_blk->nxt);
+				tmp_blk->prv = blk_link(blk_pt);
 			}
 			// Update pool's statistics
 			nb_free_blk -= 1;
@@ -533,27 +2537,28 @@ int pool_free(void * addr) {
     }
 
     // 3. Try to merge with previous block if exists
-    if (blk->prv != NULL) {
+    if (blk_ptr(blk->prv) != NULL) {
 
 		#ifdef POOL_ARENA_DEBUG
 		printf("  - Update prv\n");
-		printf("  - %p\n", (void *)blk->prv);
+		printf("  - %p\n", (void *)blk_ptr(blk->prv));
 		#endif
 
-        tmp_blk = (blk_t *)blk->prv;
-        region = (char *)blk->prv + tmp_blk->size + reg_size;
+        tmp_blk = blk_ptr(blk->prv);
+        region = (char *)blk_ptr(blk->prv) + blk_size(tmp_blk) + reg_size;
         // if previous block is contiguous the one to free, merge them
         if (region==blk_pt) {
+			index_remove(tmp_blk);
             // Update previous block by extending its size with blk (to free)
-            tmp_blk->size += reg_size + blk->size;
+            tmp_blk->size += reg_size + blk_size(blk);
             // Link blk-1 and blk+1 together
             tmp_blk->nxt = blk->nxt;
             // Current block's prv becomes the new current block
-            blk = (blk_t *)blk->prv;
+            blk = blk_ptr(blk->prv);
 			// Change nxt block to point to our new suppa block
-			if (blk->nxt != NULL) {
-				tmp_blk = (blk_t *)blk->nxt;
-				tmp_blk->prv = (void *)blk;
+			if (blk_ptr(blk->nxt) != NULL) {
+				tmp_blk = blk_ptr(blk->nxt);
+				tmp_blk->prv = blk_link(blk);
 			}
 			// Update pool's statistics
 			nb_free_blk -= 1;
@@ -561,6 +2566,11 @@ int pool_free(void * addr) {
         }
     }
 
+	#endif
+
+	// The block (maybe merged) is now ready to be chained in its class
+	index_insert(blk);
+
 	// move the head pointer the free space linked list
 	current = blk;
 
@@ -571,45 +2581,298 @@ int pool_free(void * addr) {
     return 0;
 }
 
+// -----------------------------------------------------------------------------------------------
+// Resizes an allocated block in place. To shrink, the tail is split as a block of its own then
+// released, so it merges with the next neighbor if free. To grow, the next neighbor must be free
+// and wide enough: its header moves forward by the bytes taken, or it's absorbed as a whole if
+// the remainder would be too small to be a free block.
+//
+// Arguments:
+//  - blk: the block to resize
+//  - payload: the new payload, round up and at least min_payload
+// Returns:
+//  - 1 if the block has been resized, 0 if it must move
+// -----------------------------------------------------------------------------------------------
+static int blk_resize(blk_t * blk, pool_size_t payload) {
+
+	pool_size_t old = blk_size(blk);
+	pool_size_t flags = blk->size & BLK_FLAGS;
+	pool_size_t span;
+	blk_t * nxt;
+	blk_t * rem;
+	blk_link_t prv_link;
+	blk_link_t nxt_link;
+
+	if (payload <= old) {
+
+		// The tail is too small to be a free block, the block is kept as is
+		if (old - payload < header_size)
+			return 1;
+
+		rem = (blk_t *)((char *)blk + reg_size + payload);
+		rem->size = (old - payload - reg_size) | BLK_INUSE | BLK_PINUSE;
+		blk->size = payload | flags;
+		nb_alloc_blk += 1;
+		alloc_space -= reg_size;
+		span = payload - old;
+
+		#ifdef POOL_ARENA_DEBUG
+		printf("  - shrunk in place, tail released: %p\n", (void *)rem);
+		#endif
+
+		blk_release((char *)rem + reg_size);
+
+	} else {
+
+		// The next neighbor must be free: flagged with the boundary tags, else the first free
+		// block after the block in the address-ordered linked list
+		#if POOL_ARENA_BTAG
+		nxt = blk_next(blk);
+		if (nxt != NULL && (nxt->size & BLK_INUSE))
+			nxt = NULL;
+		#else
+		nxt = get_loc_to_free(blk);
+		if (nxt != NULL && nxt < blk)
+			nxt = blk_ptr(nxt->nxt);
+		if (nxt != blk_next(blk))
+			nxt = NULL;
+		#endif
+
+		if (nxt == NULL || old + reg_size + blk_size(nxt) < payload)
+			return 0;
+
+		span = old + reg_size + blk_size(nxt);
+		prv_link = nxt->prv;
+		nxt_link = nxt->nxt;
+
+		if (span - payload >= header_size) {
+
+			// The free block's header moves forward, it keeps its place in the linked list
+			if (pool_mode != POOL_MODE_SOA)
+				index_remove(nxt);
+			rem = (blk_t *)((char *)blk + reg_size + payload);
+			rem->size = (span - payload - reg_size) | BLK_PINUSE;
+			rem->prv = prv_link;
+			rem->nxt = nxt_link;
+			blk_set_footer(rem);
+			if (pool_mode == POOL_MODE_SOA) {
+				soa_slot = soa_search(nxt);
+				soa_off[soa_slot] = (char *)rem - (char *)pool_addr;
+				soa_len[soa_slot] = blk_size(rem);
+			} else {
+				index_insert(rem);
+			}
+			if (blk_ptr(prv_link) != NULL)
+				blk_ptr(prv_link)->nxt = blk_link(rem);
+			if (blk_ptr(nxt_link) != NULL)
+				blk_ptr(nxt_link)->prv = blk_link(rem);
+			if (current == nxt)
+				current = rem;
+			free_space -= payload - old;
+
+		} else {
+
+			// The whole neighbor is absorbed, the slack folded into the block
+			index_remove(nxt);
+			if (blk_ptr(prv_link) != NULL)
+				blk_ptr(prv_link)->nxt = nxt_link;
+			if (blk_ptr(nxt_link) != NULL)
+				blk_ptr(nxt_link)->prv = prv_link;
+			if (current == nxt)
+				current = (blk_ptr(nxt_link) != NULL) ? blk_ptr(nxt_link) : blk_ptr(prv_link);
+			#if POOL_ARENA_BTAG
+			if (blk_next(nxt) != NULL)
+				blk_next(nxt)->size |= BLK_PINUSE;
+			#endif
+			nb_free_blk -= 1;
+			free_space -= blk_size(nxt);
+			payload = span;
+		}
+
+		blk->size = payload | flags;
+		alloc_space += payload - old;
+		span = payload - old;
+
+		#ifdef POOL_ARENA_DEBUG
+		printf("  - grown in place: %lu bytes\n", (unsigned long)payload);
+		#endif
+	}
+
+	// The block stays accounted with its lifetime hint, span being the payload's growth
+	if (flags & BLK_HINTS)
+		hint_space[(flags & BLK_LONG) ? 1 : 0] += span;
+
+	return 1;
+}
+
+
 int pool_check(void) {
 
-	unsigned int alloc = nb_alloc_blk * reg_size + alloc_space;
-	unsigned int free = nb_free_blk * reg_size + free_space;
+	if (engine != NULL)
+		return engine->check();
+
+	pool_size_t alloc = nb_alloc_blk * reg_size + alloc_space;
+	pool_size_t free = nb_free_blk * reg_size + free_space;
+	pool_size_t quick = nb_quick_blk * reg_size + quick_space;
 	blk_t * tmp = current;
-	int cnt = 0;
+	pool_size_t cnt = 0;
 
 	// first rewind the linked list to get the first free space block
-	while (tmp->prv != NULL)
-		tmp = (blk_t *)tmp->prv;
+	while (tmp != NULL && blk_ptr(tmp->prv) != NULL)
+		tmp = blk_ptr(tmp->prv);
 
 	while (tmp != NULL) {
-		tmp = (blk_t *)tmp->nxt;
+		tmp = blk_ptr(tmp->nxt);
 		cnt += 1;
 	}
 
+	// In segregated mode, the size classes must chain all the free blocks too
+	pool_size_t bin_cnt = 0;
+	pool_size_t bin_space = 0;
+	int bin_err = 0;
+	if (pool_mode == POOL_MODE_SEGREGATED) {
+		for (unsigned int cls = 0; cls < NB_CLASS; cls++) {
+			if ((bins[cls] != NULL) != ((bin_map[cls / 32] >> (cls % 32)) & 1))
+				bin_err = 1;
+			for (tmp = bins[cls]; tmp != NULL; tmp = blk_ptr(tmp->bin_nxt)) {
+				if (size_class(blk_size(tmp)) != cls)
+					bin_err = 1;
+				bin_cnt += 1;
+				bin_space += blk_size(tmp);
+			}
+		}
+		if (bin_cnt != nb_free_blk || bin_space != free_space)
+			bin_err = 1;
+	} else if (pool_mode == POOL_MODE_TREE) {
+		bin_cnt = tree_check(tree_root, NULL, NULL, &bin_space, &bin_err);
+		if (bin_cnt != nb_free_blk || bin_space != free_space)
+			bin_err = 1;
+	} else if (pool_mode == POOL_MODE_SOA) {
+		for (unsigned int i = 0; i < soa_cnt; i++) {
+			tmp = (blk_t *)((char *)pool_addr + soa_off[i]);
+			if ((i > 0 && soa_off[i] <= soa_off[i - 1]) || soa_off[i] >= pool_size ||
+				blk_size(tmp) != soa_len[i] || (tmp->size & BLK_INUSE))
+				bin_err = 1;
+			bin_space += soa_len[i];
+		}
+		bin_cnt = soa_cnt;
+		if (bin_cnt != nb_free_blk || bin_space != free_space || soa_cnt > soa_cap)
+			bin_err = 1;
+	}
+
+	// The quick bins must cache blocks of their size, still flagged in use
+	pool_size_t quick_cnt = 0;
+	pool_size_t quick_cached = 0;
+	int quick_err = 0;
+	for (unsigned int idx = 0; idx < NB_QUICK; idx++) {
+		for (tmp = quick_bins[idx]; tmp != NULL; tmp = blk_ptr(tmp->nxt)) {
+			if (blk_size(tmp) / reg_size != idx || (tmp->size & BLK_INUSE) != BLK_INUSE)
+				quick_err = 1;
+			quick_cnt += 1;
+			quick_cached += blk_size(tmp);
+		}
+	}
+	for (unsigned int slot = 0; slot < NB_HOT; slot++) {
+		for (tmp = hot_bins[slot]; tmp != NULL; tmp = blk_ptr(tmp->nxt)) {
+			if (blk_size(tmp) != hot_size[slot] || (tmp->size & BLK_INUSE) != BLK_INUSE)
+				quick_err = 1;
+			quick_cnt += 1;
+			quick_cached += blk_size(tmp);
+		}
+	}
+	for (unsigned int z = 0; z < nb_zone; z++) {
+		for (tmp = zone_bins[z]; tmp != NULL; tmp = blk_ptr(tmp->nxt)) {
+			if ((char *)tmp < zone_lo[z] || (char *)tmp >= zone_hi[z] ||
+				blk_size(tmp) < zone_size[z] || (tmp->size & BLK_INUSE) != BLK_INUSE)
+				quick_err = 1;
+			quick_cnt += 1;
+			quick_cached += blk_size(tmp);
+		}
+	}
+	if (quick_cnt != nb_quick_blk || quick_cached != quick_space)
+		quick_err = 1;
+
+	// The blocks flagged with a lifetime hint must match the hints' accounting. All the blocks
+	// start with their size register, so the arena is parsed block by block
+	int hint_err = 0;
+	pool_size_t hint_cnt[2] = {0, 0};
+	pool_size_t hint_used[2] = {0, 0};
+	char * walk = pool_addr;
+	while (walk < (char *)pool_addr + pool_size) {
+		tmp = (blk_t *)walk;
+		if (tmp->size & BLK_HINTS) {
+			hint_cnt[(tmp->size & BLK_LONG) ? 1 : 0] += 1;
+			hint_used[(tmp->size & BLK_LONG) ? 1 : 0] += blk_size(tmp);
+		}
+		walk += blk_size(tmp) + reg_size;
+	}
+	for (int i = 0; i < 2; i++) {
+		if (hint_cnt[i] != nb_hint_blk[i] || hint_used[i] != hint_space[i])
+			hint_err = 1;
+	}
+
+	// With the boundary tags, parse the arena block by block to check the
+	// flags and footers are coherent with the free space
+	int tag_err = 0;
+	#if POOL_ARENA_BTAG
+	pool_size_t tag_cnt = 0;
+	int prv_free = 0;
+	char * parse = pool_addr;
+	while (parse < (char *)pool_addr + pool_size) {
+		tmp = (blk_t *)parse;
+		if (((tmp->size & BLK_PINUSE) != 0) == prv_free)
+			tag_err = 1;
+		prv_free = !(tmp->size & BLK_INUSE);
+		if (prv_free) {
+			if (*(pool_size_t *)(parse + blk_size(tmp)) != blk_size(tmp))
+				tag_err = 1;
+			tag_cnt += 1;
+		}
+		parse += blk_size(tmp) + reg_size;
+	}
+	if (parse != (char *)pool_addr + pool_size || tag_cnt != nb_free_blk)
+		tag_err = 1;
+	#endif
+
 	#ifdef POOL_ARENA_DEBUG
 	printf("\n");
 	printf("------------------------------------------------------------------------\n");
 	printf("Pool Check\n");
 	printf("------------------------------------------------------------------------\n");
-	printf("Arena space: %d\n", pool_size);
+	printf("Arena space: %lu\n", (unsigned long)pool_size);
 	printf("\n");
 	printf("Allocated Space\n");
-	printf("  - nb alloc space: %d\n", nb_alloc_blk);
-	printf("  - alloc space: %d\n", alloc_space);
-	printf("  - total alloc space: %d\n", alloc);
+	printf("  - nb alloc space: %lu\n", (unsigned long)nb_alloc_blk);
+	printf("  - alloc space: %lu\n", (unsigned long)alloc_space);
+	printf("  - total alloc space: %lu\n", (unsigned long)alloc);
 	printf("\n");
 	printf("Free Space\n");
-	printf("  - nb free space: %d\n", nb_free_blk);
-	printf("  - counted nb free space: %d\n", cnt);
-	printf("  - free space: %d\n", free_space);
-	printf("  - total free space: %d\n", free);
+	printf("  - nb free space: %lu\n", (unsigned long)nb_free_blk);
+	printf("  - counted nb free space: %lu\n", (unsigned long)cnt);
+	printf("  - free space: %lu\n", (unsigned long)free_space);
+	printf("  - total free space: %lu\n", (unsigned long)free);
+	if (pool_mode == POOL_MODE_SEGREGATED || pool_mode == POOL_MODE_TREE ||
+		pool_mode == POOL_MODE_SOA) {
+		printf("  - counted nb binned space: %lu\n", (unsigned long)bin_cnt);
+		printf("  - binned space: %lu\n", (unsigned long)bin_space);
+	}
 	printf("\n");
-	printf("Arena vs Computed: %d\n", pool_size - alloc - free);
+	printf("Quick Bins\n");
+	printf("  - nb cached space: %lu\n", (unsigned long)nb_quick_blk);
+	printf("  - counted nb cached space: %lu\n", (unsigned long)quick_cnt);
+	printf("  - cached space: %lu\n", (unsigned long)quick_space);
+	printf("\n");
+	printf("Lifetime Hints\n");
+	printf("  - nb short-lived space: %lu\n", (unsigned long)nb_hint_blk[0]);
+	printf("  - short-lived space: %lu\n", (unsigned long)hint_space[0]);
+	printf("  - nb long-lived space: %lu\n", (unsigned long)nb_hint_blk[1]);
+	printf("  - long-lived space: %lu\n", (unsigned long)hint_space[1]);
+	printf("\n");
+	printf("Arena vs Computed: %lu\n", (unsigned long)(pool_size - alloc - free - quick));
 	printf("------------------------------------------------------------------------\n");
 	#endif
 
-	if (pool_size != (alloc + free)) {
+	if (pool_size != (alloc + free + quick)) {
 		#ifdef POOL_ARENA_DEBUG
 		printf("ERROR: Free space size doesn't match\n");
 		printf("------------------------------------------------------------------------\n");
@@ -625,6 +2888,38 @@ int pool_check(void) {
 		return 1;
 	}
 
+	if (bin_err) {
+		#ifdef POOL_ARENA_DEBUG
+		printf("ERROR: Free blocks' index doesn't match the free space\n");
+		printf("------------------------------------------------------------------------\n");
+		#endif
+		return 1;
+	}
+
+	if (hint_err) {
+		#ifdef POOL_ARENA_DEBUG
+		printf("ERROR: Lifetime hints don't match the allocated space\n");
+		printf("------------------------------------------------------------------------\n");
+		#endif
+		return 1;
+	}
+
+	if (quick_err) {
+		#ifdef POOL_ARENA_DEBUG
+		printf("ERROR: Quick bins don't match the cached space\n");
+		printf("------------------------------------------------------------------------\n");
+		#endif
+		return 1;
+	}
+
+	if (tag_err) {
+		#ifdef POOL_ARENA_DEBUG
+		printf("ERROR: Boundary tags don't match the free space\n");
+		printf("------------------------------------------------------------------------\n");
+		#endif
+		return 1;
+	}
+
 	return 0;
 }
 
@@ -634,9 +2929,14 @@ void pool_log(void) {
 	void * end;
 	blk_t * tmp = current;
 
+	if (engine != NULL) {
+		engine->log();
+		return;
+	}
+
 	// first rewind the linked list to get the first free space block
-	while (tmp->prv != NULL)
-		tmp = (blk_t *)tmp->prv;
+	while (tmp != NULL && blk_ptr(tmp->prv) != NULL)
+		tmp = blk_ptr(tmp->prv);
 
 	printf("\n");
 	printf("------------------------------------------------------------------------\n");
@@ -645,7 +2945,7 @@ void pool_log(void) {
 	end = (char *)pool_addr + pool_size - 1;
 	printf("Addr: %p\t", pool_addr);
 	printf("End: %p\t", end);
-	printf("Size: %d\t", pool_size);
+	printf("Size: %lu\t", (unsigned long)pool_size);
 	printf("\n");
 	printf("------------------------------------------------------------------------\n");
 
@@ -653,22 +2953,89 @@ void pool_log(void) {
 	printf("------------------------------------------------------------------------\n");
 	// move forward to print one by one the blocks
 	while (tmp != NULL) {
-		end = (char *)tmp + tmp->size + reg_size - 1;
+		end = (char *)tmp + blk_size(tmp) + reg_size - 1;
 		printf("Addr: %p\t", (void*)tmp);
 		printf("End: %p\t", end);
-		printf("Size: %d\t", tmp->size);
-		printf("Prv: %p\t", (void*)tmp->prv);
-		printf("Nxt: %p\t", (void*)tmp->nxt);
+		printf("Size: %lu\t", (unsigned long)blk_size(tmp));
+		printf("Prv: %p\t", (void*)blk_ptr(tmp->prv));
+		printf("Nxt: %p\t", (void*)blk_ptr(tmp->nxt));
 		printf("\n");
-		tmp = (blk_t *)tmp->nxt;
+		tmp = blk_ptr(tmp->nxt);
 	}
 	printf("------------------------------------------------------------------------\n");
+
+	if (pool_mode == POOL_MODE_SEGREGATED) {
+		printf("Size Classes\n");
+		printf("------------------------------------------------------------------------\n");
+		for (unsigned int cls = 0; cls < NB_CLASS; cls++) {
+			if (bins[cls] == NULL)
+				continue;
+			printf("Class: %d\t", cls);
+			for (tmp = bins[cls]; tmp != NULL; tmp = blk_ptr(tmp->bin_nxt))
+				printf("%p (%lu) ", (void *)tmp, (unsigned long)blk_size(tmp));
+			printf("\n");
+		}
+		printf("------------------------------------------------------------------------\n");
+	} else if (pool_mode == POOL_MODE_TREE) {
+		printf("Size Tree\n");
+		printf("------------------------------------------------------------------------\n");
+		tree_log(tree_root, 0);
+		printf("------------------------------------------------------------------------\n");
+	} else if (pool_mode == POOL_MODE_SOA) {
+		printf("Side Arrays (%lu / %lu entries)\n", (unsigned long)soa_cnt, (unsigned long)soa_cap);
+		printf("------------------------------------------------------------------------\n");
+		for (unsigned int i = 0; i < soa_cnt; i++)
+			printf("Offset: %lu\tSize: %lu\n", (unsigned long)soa_off[i], (unsigned long)soa_len[i]);
+		printf("------------------------------------------------------------------------\n");
+	}
+
+	if (nb_quick_blk > 0) {
+		printf("Quick Bins\n");
+		printf("------------------------------------------------------------------------\n");
+		for (unsigned int idx = 0; idx < NB_QUICK; idx++) {
+			if (quick_bins[idx] == NULL)
+				continue;
+			printf("Size: %d\t", idx * reg_size);
+			for (tmp = quick_bins[idx]; tmp != NULL; tmp = blk_ptr(tmp->nxt))
+				printf("%p ", (void *)tmp);
+			printf("\n");
+		}
+		for (unsigned int slot = 0; slot < NB_HOT; slot++) {
+			if (hot_bins[slot] == NULL)
+				continue;
+			printf("Hot size: %lu\t", (unsigned long)hot_size[slot]);
+			for (tmp = hot_bins[slot]; tmp != NULL; tmp = blk_ptr(tmp->nxt))
+				printf("%p ", (void *)tmp);
+			printf("\n");
+		}
+		for (unsigned int z = 0; z < nb_zone; z++) {
+			if (zone_bins[z] == NULL)
+				continue;
+			printf("Zone size: %lu\t", (unsigned long)zone_size[z]);
+			for (tmp = zone_bins[z]; tmp != NULL; tmp = blk_ptr(tmp->nxt))
+				printf("%p ", (void *)tmp);
+			printf("\n");
+		}
+		printf("------------------------------------------------------------------------\n");
+	}
+
+	if (nb_scope > 0) {
+		printf("Scopes\n");
+		printf("------------------------------------------------------------------------\n");
+		printf("Region: %p\tEnd: %p\tTop: %p\tDepth: %d\n", (void *)scope_lo, (void *)scope_hi,
+			   (void *)scope_top, nb_scope);
+		printf("------------------------------------------------------------------------\n");
+	}
 	printf("\n");
 }
 
 // Return the size of chunk located @ address
-unsigned int pool_get_size(void * addr) {
+pool_size_t pool_get_size(void * addr) {
+	if (scope_owns(addr))
+		return blk_size((blk_t *)((char *)addr - reg_size));
+	if (engine != NULL)
+		return engine->get_size(addr);
     void * blk_pt = (char *)addr - reg_size;
     blk_t * blk = blk_pt;
-	return blk->size;
+	return blk_size(blk);
 }
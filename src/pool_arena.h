@@ -71,9 +71,25 @@ Parse the free space to find a chunk. Check if current block can contain the req
      - If a block is found, apply (1)
      - If not, return -1
 
+Step (2) is the next-fit placement policy, the default one. The policy can be selected with
+pool_init_mode(), or at compile time with POOL_ARENA_POLICY for pool_init():
+     - POOL_FIT_NEXT: roving search from the last free block manipulated (default)
+     - POOL_FIT_FIRST: block wide enough with the lowest address (the whole free space is
+       parsed with the boundary tags, the free space not being ordered by address)
+     - POOL_FIT_BEST: narrowest block wide enough, the whole free space is parsed
+     - POOL_FIT_WORST: widest block, the whole free space is parsed
+The policies only select the block to fork, free() is not affected. In segregated mode, the size
+classes already select a good fit and the policy is ignored.
+
 Size requested is always round up to the next size, i.e. 30 bytes are round up to 32, ...
 Size too small, smaller than 3 register size (32 or 64 bits are set as 3 reg_size
 
+A block is selected as soon as its payload can store the request. If the remainder after the fork
+would be too small to be a free block (a size register and the links), the whole block is consumed:
+it's unlinked from the free space and the slack is folded into the allocation, pool_get_size()
+reporting the real usable size. So an exact hole is always used, and the free space can be fully
+allocated, the free space linked list being then empty.
+
 ## free()
 
 1. Locate the block to free accross the chained list. nxt/prv pointers are used to move until
@@ -86,8 +102,366 @@ Size too small, smaller than 3 register size (32 or 64 bits are set as 3 reg_siz
 4. If previous block is contiguous, merge it:
   - update the size of the previous block by adding the chunk size
   - update the current.nxt block's prv pointer to the new merged block address
+
+## realloc()
+
+realloc() resizes the block in place when it can: to shrink, the tail is split as a block of its
+own and released, so merged with the next neighbor if free; to grow, the next neighbor must be
+free and wide enough, its header moves forward by the bytes taken (or it's absorbed as a whole
+if the remainder can't be a free block). The next neighbor is reached directly with the boundary
+tags, else found in the free space linked list like in free(). Otherwise the block moves, only
+the bytes of the smaller size being copied. The blocks of the other engines, of the zones and of
+the scopes only shrink in place, keeping their size.
+
+## Aligned allocation
+
+pool_aligned_alloc() aligns the payload on a power of two wider than a register, for the SIMD
+data or the structures isolated on their cache line. A free block wide enough for the payload and
+the worst-case slack is forked, then the slack before the aligned payload is split as a block
+of its own and released, merged with its free previous neighbor, and the unused tail is released
+as in realloc(). The result is a regular block: its size register precedes the payload, so free()
+and get_size() work as is. In a scope, the padding is bumped with the block.
+
+## Batches
+
+pool_malloc_batch() allocates n blocks of the same size with a single search of the free space:
+a chunk of n contiguous blocks is allocated then split in place. If no free block is wide
+enough, the chunk is halved until it fits, and the search goes on for the remaining blocks, so a
+fragmented arena costs a few searches instead of n. pool_free_batch() sorts the addresses, folds
+the contiguous blocks in a single one, then releases the runs by address: free() parses the
+linked list from the last block released, so the whole batch costs a single forward parse of
+the free space.
+
+## Co-allocation
+
+pool_comalloc() allocates the n objects of a composite record, of different sizes, with a single
+search of the free space: a chunk wide enough for all of them is allocated then split in place,
+each object getting its own size register. The objects are contiguous in the order given, so
+the record spans adjacent cache lines, and each one is released with free() as any block.
+
+## Boundary tags
+
+When built with POOL_ARENA_BTAG=1, the two LSBs of the size register flag if the block is in use
+and if its previous neighbor is in use. A free block also copies its size in its last register
+(footer). free() so reaches directly the neighbors of the block to release and merges them
+without parsing the free space: the block takes the place of its free next neighbor in the linked
+list, is absorbed by its free previous neighbor, or is chained after the current free block. The
+free space linked list is then no longer ordered by address.
+
+This layout costs one more register in a free block, so the minimum payload is 3 registers. The
+default layout (POOL_ARENA_BTAG=0) has the smallest overhead, e.g. for RISCV 32 bits targets.
+The lifetime hints then move to the two MSBs of the size register, so they're only available on
+the arenas under 1 GB (4 EB with the wide layout).
+
+## Wide layout
+
+When built with POOL_ARENA_WIDE=1, the sizes are size_t instead of 32 bits: the API (pool_size_t),
+the size registers, the boundary tags' footers, the SoA side arrays and the statistics, so the
+list engine's modes manage arenas and blocks beyond 4 GB on 64 bits targets. On these targets the
+size register already takes 8 bytes, so the blocks don't grow. On 32 bits targets, size_t is 32
+bits and the layout doesn't change anything. The segregated mode gets 64 power of two classes, and
+the SoA scan is no longer vectorized. The TLSF, buddy and bitmap engines stay limited to 4 GB:
+they manage the first 4 GB of a wider arena and reject wider requests. Not compatible with
+POOL_ARENA_COMPACT.
+
+## Compact layout
+
+When built with POOL_ARENA_COMPACT=1, the registers of the list engine's modes are 32 bits wide
+on 64 bits targets too: the size register takes 4 bytes and the links of the free blocks (prv,
+nxt and the index links) are 32 bits offsets from the arena's start instead of pointers. A block
+costs 4 bytes of header instead of 8, and the smallest block is 12 bytes instead of 24, so the
+arenas full of small nodes shrink by up to a quarter. The payloads are then only aligned on 4
+bytes: the data needing a wider alignment must be padded by the caller, or allocated in another
+engine. The layout has no effect on 32 bits targets, nor on the TLSF, buddy and bitmap engines.
+
+## Tail carving
+
+By default, malloc() places the new block at the head of the free block selected, so the free
+block's header moves forward: its size, prv and nxt are rewritten at the new address and its
+previous and next free blocks are patched to link it, up to 4 cache lines dirtied. With the
+POOL_OPT_TAIL option, the new block is carved from the tail of the free block: only the free
+block's size changes (and its footer with the boundary tags), its neighbors are untouched.
+Without the boundary tags, the free space linked list then stays ordered by address whatever the
+allocations; with them, free() still chains the blocks out of order. `make bench` compares both
+layouts.
+
+## Quick bins
+
+With the POOL_OPT_QUICK option, free() doesn't merge the small blocks, up to 15 registers of
+payload, but caches them in a quick bin: a LIFO list per payload size. malloc() first checks the
+quick bin of the size requested and returns its last block as is, so a loop releasing and
+allocating again the same few sizes doesn't parse nor fork the free space. The cached blocks stay
+flagged in use, so they're never merged with their neighbors. They're released in the free space,
+and merged, by pool_consolidate(), called by malloc() when no free block is wide enough.
+
+## Adaptive size classes
+
+With the POOL_OPT_ADAPT option, malloc() counts the payload sizes requested, up to 63 registers,
+in a histogram. Every POOL_ARENA_ADAPT_WINDOW mallocs (1024 by default), the 4 most requested
+sizes are elected hot and get a dedicated LIFO list, working like a quick bin: free() caches the
+blocks of a hot size and malloc() reuses them as is. The lists of the sizes no longer hot are
+released in the free space, then the counts are halved, so the hot sizes follow the traffic of a
+long-running application without any tuning. The warm-up is the first window: no block is cached
+before. pool_consolidate() also releases the hot lists.
+
+## Zones
+
+pool_init_zones() declares at startup the object sizes the application allocates the most, with
+their count. A zone per size is reserved at the head of the arena and split in count blocks, so
+a pool_malloc() of a zone's size takes a block of the zone in constant time, without parsing the
+free space, and pool_free() caches it back in its zone. The zones' blocks are never merged, a
+zone stays reserved to its size. Once a zone is exhausted, or for the other sizes, malloc()
+falls back on the free space.
+
+## Scopes
+
+pool_scope_begin() opens a scope for the request-scoped objects: the outermost scope carves a
+region from the arena, then pool_malloc() only bumps a pointer in it, a size register then the
+payload, and pool_free() of a block of the region does nothing. pool_scope_end() reclaims all
+the blocks of the scope at once by restoring the pointer, whatever their number; the outermost
+scope releases the region with a single free(). The scopes nest: a nested scope marks the
+pointer when it begins and restores it when it ends. Once the region is full, malloc() returns
+NULL until a scope ends, the objects never escape in the free space. pool_reset() drops the
+whole arena back to the state of its last pool_init(): it drops the blocks, the scopes and the
+caches, and carves again the zones of pool_init_zones(), all their blocks free. Its cost is the
+one of the init, constant for all the engines but the buddy and the bitmap ones, which clear
+their bitmaps.
+
+## Double-ended arena
+
+With the POOL_OPT_DOUBLE option, malloc() places the blocks smaller than POOL_ARENA_LARGE bytes
+(256 by default) from the low end of the arena, in the free block wide enough with the lowest
+address forked from its head, and the larger ones from the high end, in the free block wide
+enough with the highest address carved from its tail. So the long-lived large buffers and the
+churning small objects don't interleave: the large holes stay large and the small objects stay
+compact. free() merges the blocks by address, whatever their region. The ends are selected in
+list and SoA modes, the free space being ordered by address; in segregated and tree modes, the
+block is selected by size and only the carving side applies. POOL_OPT_DOUBLE overrides
+POOL_OPT_TAIL.
+
+## Lifetime hints
+
+pool_malloc_hint() places the short-lived blocks (POOL_HINT_SHORT) and the long-lived ones
+(POOL_HINT_LONG) as the small and large blocks of the double-ended arena, whatever their size and
+the POOL_OPT_DOUBLE option: the per-request temporaries churn at the low end and don't fragment
+the high end where the long-lived data sits. The hint is stored in the two LSBs of the block's
+size register, free as the sizes are multiple of registers. With POOL_ARENA_BTAG these LSBs
+flag the boundary tags, so the hint is stored in the two MSBs instead: on an arena of 1 GB or
+more (4 EB if wide), the sizes own these bits and pool_malloc_hint() returns NULL for a hint.
+pool_check() counts the blocks and the payload allocated per hint and checks them against the
+arena's content.
+
+## Segregated mode
+
+With POOL_MODE_SEGREGATED, the free blocks are also chained in lists per size class, a class
+being a power of two divided in 4 linear sub-classes. A bitmap flags the non-empty classes. So
+malloc() doesn't parse the whole free space but only the class of the requested size, then jumps
+directly to the first non-empty wider class if needed. free() unchains the merged neighbors from
+their class and chains the released block into its own class.
+
+The class links are stored in the free blocks after prv/nxt, so the minimum payload is 4
+registers instead of 2.
+
+## Tree mode
+
+With POOL_MODE_TREE, the free blocks are also stored in a balanced tree ordered by size, then by
+address. The tree is a treap: the priority of a node is a hash of its address, so no field is
+needed to balance it and its expected depth is O(log n). malloc() descends the tree to pick the
+narrowest block wide enough, so a best-fit in O(log n) instead of a parse of the whole free space.
+free() removes the merged neighbors from the tree and inserts the released block.
+
+The tree mode always places the blocks as a best-fit, the placement policy is ignored. The tree
+links are stored as the class links of the segregated mode, so the minimum payload is 4 registers.
+
+## SoA mode
+
+With POOL_MODE_SOA, the offsets and the sizes of the free blocks are also stored in two arrays,
+sorted by address. malloc() doesn't chase the prv/nxt pointers, one cache miss per free block,
+but scans the contiguous sizes array, 8 sizes per comparison with AVX2 or 4 with SSE2, to
+select the first block wide enough by address. free() finds the free neighbors of the block with
+a binary search over the offsets. Inserting or removing an entry moves the entries after it, so
+both stay bounded by the memory bandwidth even on a heavily fragmented arena.
+
+The arrays are placed at the head of the arena and are sized for the worst case, one free block
+per two minimal blocks: 8 bytes per 6 registers of arena (8 registers with boundary tags). The
+SoA mode always places the blocks as a first-fit, the placement policy is ignored.
+
+## TLSF mode
+
+With POOL_MODE_TLSF, the arena is managed by a two-level segregated fit engine, so the duration of
+malloc() and free() doesn't depend on the number of blocks. The free blocks are chained per class:
+a first level per power of two, split in 16 linear second level classes. A bitmap flags the
+non-empty first level classes, and one bitmap per first level flags its non-empty second level
+classes. The blocks use boundary tags, as the list engine built with POOL_ARENA_BTAG=1.
+
+malloc() rounds up the size to the next class boundary, so any block of this class fits, finds the
+first non-empty class with a find-first-set on each bitmap, unchains the head of the class and
+forks it. free() merges the block with its free physical neighbors and chains it in its class.
+
+Worst-case, whatever the fragmentation:
+     - malloc(): 2 find-last-set, 2 find-first-set, 2 class unchain/chain, 1 fork
+     - free(): 3 class unchain/chain, 1 find-last-set per unchain/chain
+No loop depends on the arena content. With the Zbb extension (RISCV) or on x86, find-first/last-set
+are single instructions, so malloc()/free() take around a hundred instructions. Without it, they
+fall back to a loop of at most 32 iterations each.
+
+`make bench` measures the worst-case cycles: each malloc() and free() of a fragmented arena is
+timed with the cycle counter (rdtsc on x86, rdcycle on RISCV), keeps its fastest time over 20
+replays to filter out the interrupts, and the slowest one is reported, the counter's overhead
+included. On a x86-64 host, malloc() and free() take at most around 100 cycles each (up to 300
+with the noise of a loaded machine), where the list engine's malloc() exceeds 4000 cycles on the
+same arena. A target's own bound is measured by running the benchmark on it.
+
+## Buddy mode
+
+With POOL_MODE_BUDDY, the arena is managed by a binary buddy engine, suited to power-of-two
+buffers. The head of the arena stores two bitmaps with one bit per node of the buddy tree: free
+(the block is chained in its order's free list) and split (the block is forked in two buddies).
+The tree is placed after, aligned on 64 bytes; if the arena is not a power of two, the nodes
+beyond its end are never released.
+
+malloc() rounds up the size to the next power of two (2 registers at minimum), takes the first
+non-empty order with a find-first-set on the orders' bitmap, and splits the block down to the
+order requested, releasing each right buddy. free() finds back the block's order by descending the
+split nodes, then merges the block with its buddy (offset ^ size) as long as this one is free.
+Both run in O(log n). The allocated blocks don't own any header, so a power-of-two buffer doesn't
+waste any space. pool_check() and pool_log() report the occupancy of each order.
+
+## Bitmap mode
+
+With POOL_MODE_BITMAP, the arena is split in granules of 16 bytes (POOL_ARENA_GRANULE). Two
+bitmaps at the head of the arena store one bit per granule: used, and last granule of a block.
+The blocks don't own any header, so a small object costs its granules and 2 bits instead of a
+size register, and the bitmaps are far denser than the free blocks' headers.
+
+This is the out-of-band metadata mode: nothing is stored in the granules, so an overrun of a
+block can't corrupt the allocator, and malloc(), free() and pool_check() only read and write the
+bitmaps, 64 times smaller than the granules by default. The granules start on a cache line of
+their own. Built with POOL_ARENA_NATURAL (0 by default), the blocks are naturally aligned: a
+block starts on the largest power of two not above its size, up to POOL_ARENA_NATURAL bytes, so
+a 64 bytes object fills a single cache line and a 4 KB buffer a single page with
+POOL_ARENA_NATURAL=4096.
+
+malloc() searches the first run of free granules wide enough: the bitmap is parsed a word at
+once with find-first-set, jumping from a free granule to the next used one and back, and the
+fully used words are skipped 4 at once with SSE2. The search starts from the lowest free
+granule. free() finds the end of the block with the last bitmap and clears its bits: no list to
+update and nothing to merge. pool_check() counts the granules with a population count per word.
+
+## Ring mode
+
+With POOL_MODE_RING, the arena is a ring for the buffers released roughly in the order they're
+allocated, like the messages of a pipeline. A block is a header of 8 bytes, its size and if it's
+in use, then its payload. malloc() places the block at the tail of the ring, free() moves the
+head over the block if it's the oldest one: both run in constant time, without any list to
+parse. A block released out of order is only flagged: the head stays on the oldest block in use
+and moves over all the blocks released behind it once this one is released. If the space up to
+the end of the ring is too narrow, it's padded and the block is placed at the start.
+pool_ring_mirror() (Linux only) maps a region twice in a row on the same memory with
+memfd_create(): a ring initialized on it places the blocks across its end without padding, the
+payload staying contiguous in the second mapping.
+
+## Slabs
+
+A slab is a single block of the arena storing count objects of the same size. The objects don't
+have any size register, a released object stores the link to the next released one. So
+pool_slab_alloc() and pool_slab_free() run in constant time without any per object overhead.
+The slab objects must not be passed to pool_free() or pool_get_size().
  ----------------------------------------------------------------------------------------------- */
 
+// Boundary tags layout: O(1) merging in free(), but one more register per free block
+#ifndef POOL_ARENA_BTAG
+#define POOL_ARENA_BTAG         0
+#endif
+
+// Compact layout: 32 bits size registers and offset links on 64 bits targets
+#ifndef POOL_ARENA_COMPACT
+#define POOL_ARENA_COMPACT      0
+#endif
+
+// Wide layout: size_t sizes for the arenas and the blocks beyond 4 GB
+#ifndef POOL_ARENA_WIDE
+#define POOL_ARENA_WIDE         0
+#endif
+
+#if POOL_ARENA_WIDE && POOL_ARENA_COMPACT
+#error "POOL_ARENA_WIDE and POOL_ARENA_COMPACT are exclusive"
+#endif
+
+// Size of the arena and of the blocks
+#if POOL_ARENA_WIDE
+#include <stddef.h>
+typedef size_t pool_size_t;
+#else
+typedef unsigned int pool_size_t;
+#endif
+
+// Smallest payload placed from the high end of the arena with POOL_OPT_DOUBLE
+#ifndef POOL_ARENA_LARGE
+#define POOL_ARENA_LARGE        256
+#endif
+
+// Number of mallocs between two elections of the hot sizes with POOL_OPT_ADAPT
+#ifndef POOL_ARENA_ADAPT_WINDOW
+#define POOL_ARENA_ADAPT_WINDOW 1024
+#endif
+
+// Maximum number of zones declared to pool_init_zones()
+#ifndef POOL_ARENA_ZONES
+#define POOL_ARENA_ZONES        8
+#endif
+
+// Maximum number of objects co-allocated by pool_comalloc()
+#ifndef POOL_ARENA_COMALLOC
+#define POOL_ARENA_COMALLOC     16
+#endif
+// Maximum number of scopes open at once
+#ifndef POOL_ARENA_SCOPES
+#define POOL_ARENA_SCOPES       8
+#endif
+// Size of an allocation unit in bitmap mode, a power of two
+#ifndef POOL_ARENA_GRANULE
+#define POOL_ARENA_GRANULE      16
+#endif
+
+// Cap in bytes of the blocks' natural alignment in bitmap mode, a power of two, 0 to disable
+#ifndef POOL_ARENA_NATURAL
+#define POOL_ARENA_NATURAL      0
+#endif
+
+// Allocation engines, selected with pool_init_mode()
+#define POOL_MODE_LIST          0
+#define POOL_MODE_SEGREGATED    1
+#define POOL_MODE_TLSF          2
+#define POOL_MODE_BUDDY         3
+#define POOL_MODE_TREE          4
+#define POOL_MODE_SOA           5
+#define POOL_MODE_BITMAP        6
+#define POOL_MODE_RING          7
+
+// Placement policies, or'ed with the engine in pool_init_mode()
+#define POOL_FIT_NEXT           0x00
+#define POOL_FIT_FIRST          0x10
+#define POOL_FIT_BEST           0x20
+#define POOL_FIT_WORST          0x30
+#define POOL_FIT_MASK           0x30
+
+// Options of the list engine's modes, or'ed with the engine in pool_init_mode()
+#define POOL_OPT_TAIL           0x100
+#define POOL_OPT_QUICK          0x200
+#define POOL_OPT_DOUBLE         0x400
+#define POOL_OPT_ADAPT          0x800
+#define POOL_OPT_MASK           0xF00
+
+// Lifetime hints of pool_malloc_hint()
+#define POOL_HINT_SHORT         0x1
+#define POOL_HINT_LONG          0x2
+
+// Placement policy used by pool_init()
+#ifndef POOL_ARENA_POLICY
+#define POOL_ARENA_POLICY       POOL_FIT_NEXT
+#endif
+
 // -----------------------------------------------------------------------------------------------
 // Called by the environment to setup the arena start address
 // To call once when the system boots up or when creating
@@ -99,21 +473,114 @@ Size too small, smaller than 3 register size (32 or 64 bits are set as 3 reg_siz
 // Returns:
 //  - -1 if size is too small to contain at least 1 byte, otherwise 0
 // -----------------------------------------------------------------------------------------------
-int pool_init(void * addr, unsigned int size);
+int pool_init(void * addr, pool_size_t size);
+
+// -----------------------------------------------------------------------------------------------
+// Same than pool_init() but selects the allocation engine
+//
+// Arguments:
+//  - addr: address of the arena's first byte
+//  - size: size in byte available for the arena
+//  - mode: POOL_MODE_LIST (pool_init() default), POOL_MODE_SEGREGATED, POOL_MODE_TREE,
+//          POOL_MODE_SOA, POOL_MODE_TLSF, POOL_MODE_BUDDY, POOL_MODE_BITMAP or POOL_MODE_RING,
+//          or'ed with
+//          a POOL_FIT_* placement policy (POOL_ARENA_POLICY for pool_init()) and POOL_OPT_*
+//          options. The policy only applies to POOL_MODE_LIST, the options to the list,
+//          segregated, tree and SoA modes
+// Returns:
+//  - -1 if size is too small to contain at least 1 byte or mode is unknown, otherwise 0
+// -----------------------------------------------------------------------------------------------
+int pool_init_mode(void * addr, pool_size_t size, int mode);
+
+// Zone declared to pool_init_zones(): count objects of size bytes
+typedef struct pool_zone {
+    pool_size_t size;
+    unsigned int count;
+} pool_zone_t;
+
+// -----------------------------------------------------------------------------------------------
+// Same than pool_init() but reserves at the head of the arena a zone per object size declared,
+// split in blocks of that size. pool_malloc() serves the sizes of the zones from their zone in
+// constant time until exhausted, the other sizes from the free space
+//
+// Arguments:
+//  - addr: address of the arena's first byte
+//  - size: size in byte available for the arena
+//  - zones: the object sizes and their count, a size per zone once round up
+//  - n: the number of zones, up to POOL_ARENA_ZONES
+// Returns:
+//  - -1 if the zones are invalid or can't be stored in the arena, otherwise 0
+// -----------------------------------------------------------------------------------------------
+int pool_init_zones(void * addr, pool_size_t size, const pool_zone_t * zones, unsigned int n);
 
 // -----------------------------------------------------------------------------------------------
 // Memory allocation. Allocates in the arena a buffer of _size_ bytes. Memory
 // blocked reserved in memory are always boundary aligned with the hw
 // architecture, so 4 bytes for 32 bits architecture, or 8 bytes for 64 bits
-// architecture. Use first-fit startegy for the moment (but could use
-// best-fit).
+// architecture. The free block is selected with the placement policy given
+// to pool_init_mode() (next-fit by default).
 //
 // Argument:
 //  - size: the number of bytes the block needs to own
 // Returns:
 //  - the address of the buffer's first byte, otherwise -1 if failed
 // -----------------------------------------------------------------------------------------------
-void * pool_malloc(unsigned int size);
+void * pool_malloc(pool_size_t size);
+
+// -----------------------------------------------------------------------------------------------
+// Same than pool_malloc() but places the block following its expected lifetime, from the low
+// end of the arena for POOL_HINT_SHORT, from the high end for POOL_HINT_LONG. The block is
+// accounted per hint by pool_check() until released.
+//
+// Argument:
+//  - size: the number of bytes the block needs to own
+//  - hint: POOL_HINT_SHORT, POOL_HINT_LONG, or 0 for the pool_malloc() placement
+// Returns:
+//  - the address of the buffer's first byte, otherwise -1 if failed
+// -----------------------------------------------------------------------------------------------
+void * pool_malloc_hint(pool_size_t size, int hint);
+
+// -----------------------------------------------------------------------------------------------
+// Same than pool_malloc() but the payload is aligned on alignment bytes, e.g. 64 for a cache line.
+// The slack before the aligned payload goes back to the free space, and the block can be passed
+// to pool_free(), pool_get_size() or pool_realloc() as any other. The TLSF, buddy, bitmap and
+// ring engines only return the block they'd give to pool_malloc() if already aligned
+//
+// Arguments:
+//  - alignment: the alignment of the payload in bytes, a power of two
+//  - size: the number of bytes the block needs to own
+// Returns:
+//  - the address of the buffer's first byte, NULL if failed or alignment is not a power of two
+// -----------------------------------------------------------------------------------------------
+void * pool_aligned_alloc(pool_size_t alignment, pool_size_t size);
+
+// -----------------------------------------------------------------------------------------------
+// Allocates n objects of different sizes living together, e.g. the parts of a composite record.
+// In the list engine's modes, they're carved contiguously from a single allocation, so a single
+// search of the free space and adjacent cache lines. Each object is released on its own with
+// pool_free(). The other engines and the scopes allocate them one by one
+//
+// Arguments:
+//  - n: the number of objects, up to POOL_ARENA_COMALLOC
+//  - sizes: the size in bytes of each object
+//  - out: the n addresses of the objects
+// Returns:
+//  - 0 if all the objects have been allocated, -1 otherwise, none being allocated
+// -----------------------------------------------------------------------------------------------
+int pool_comalloc(unsigned int n, const pool_size_t * sizes, void ** out);
+
+// -----------------------------------------------------------------------------------------------
+// Allocates n blocks of size bytes at once. In the list engine's modes, the blocks are carved
+// from a few wide allocations split in place, instead of a search of the free space per block
+//
+// Arguments:
+//  - size: the number of bytes each block needs to own
+//  - n: the number of blocks
+//  - out: the n addresses of the blocks allocated
+// Returns:
+//  - the number of blocks allocated, less than n if the arena is exhausted
+// -----------------------------------------------------------------------------------------------
+unsigned int pool_malloc_batch(pool_size_t size, unsigned int n, void ** out);
 
 // -----------------------------------------------------------------------------------------------
 // Clear alloc. Same than pool_malloc() but erase with zero the zone allocated
@@ -123,18 +590,21 @@ void * pool_malloc(unsigned int size);
 // Returns:
 //  - the address of the buffer's first byte, otherwise -1 if failed
 // -----------------------------------------------------------------------------------------------
-void * pool_calloc(unsigned int size);
+void * pool_calloc(pool_size_t size);
 
 // -----------------------------------------------------------------------------------------------
-// Used to place existibng block in a wider space. If failed, the existing block remains OK
+// Resizes a block. In the list engine's modes, the block shrinks in place, its tail released in
+// the free space, and grows in place if its next neighbor is free and wide enough. Else the
+// block moves, only the bytes of the smaller size being copied. If failed, the existing block
+// remains OK
 //
 // Arguments:
-//  - addr: address of the chunk to move
+//  - addr: address of the chunk to resize, NULL to allocate a new one
 //  - size: size in byte of the chunk
 // Returns:
-//  - -1 if failed to allocate the new block
+//  - the address of the chunk, NULL if failed to allocate the new block
 // -----------------------------------------------------------------------------------------------
-void * pool_realloc(void * addr, unsigned int size);
+void * pool_realloc(void * addr, pool_size_t size);
 
 // -----------------------------------------------------------------------------------------------
 // Releases a block and make it available again for future use.
@@ -146,6 +616,19 @@ void * pool_realloc(void * addr, unsigned int size);
 // -----------------------------------------------------------------------------------------------
 int pool_free(void * addr);
 
+// -----------------------------------------------------------------------------------------------
+// Releases n blocks at once. The addresses are sorted, the contiguous blocks folded together,
+// then released in a single forward parse of the free space. The quick bins and the hot lists
+// are bypassed, the blocks are merged in the free space
+//
+// Arguments:
+//  - ptrs: the addresses of the blocks, sorted in place, the NULL ones being ignored
+//  - n: the number of addresses
+// Returns:
+//  - 0 if the blocks have been released, -1 otherwise
+// -----------------------------------------------------------------------------------------------
+int pool_free_batch(void ** ptrs, unsigned int n);
+
 // -----------------------------------------------------------------------------------------------
 // Check the free space setup during pool_init() is still completely available, even if free
 // space has been fragmented
@@ -169,13 +652,136 @@ void pool_log(void);
 
 
 // -----------------------------------------------------------------------------------------------
-// Returns the size of a chunk in the pool previously allocated
+// Releases in the free space the blocks cached in the quick bins (POOL_OPT_QUICK) and in the hot
+// lists (POOL_OPT_ADAPT), merging them with their free neighbors
+//
+// Arguments:
+//	- None
+// Returns:
+// 	- the number of blocks released
+// -----------------------------------------------------------------------------------------------
+int pool_consolidate(void);
+
+// -----------------------------------------------------------------------------------------------
+// Opens a scope. The outermost scope carves a region of size bytes from the arena. Until the
+// scope ends, pool_malloc() and its variants bump a pointer in the region, and pool_free() of
+// a block of the region does nothing. The scopes nest up to POOL_ARENA_SCOPES deep
+//
+// Arguments:
+//	- size: the number of bytes of the region, ignored by the nested scopes
+// Returns:
+// 	- 0 if the scope is open, -1 if the region can't be carved or too many scopes are open
+// -----------------------------------------------------------------------------------------------
+int pool_scope_begin(pool_size_t size);
+
+// -----------------------------------------------------------------------------------------------
+// Closes the innermost scope, reclaiming in constant time all the blocks allocated since it
+// began. The outermost scope releases its region in the arena
+//
+// Arguments:
+//	- None
+// Returns:
+// 	- 0 if a scope was open, -1 otherwise
+// -----------------------------------------------------------------------------------------------
+int pool_scope_end(void);
+
+// -----------------------------------------------------------------------------------------------
+// Drops all the blocks, scopes, caches and zones: the arena gets back the state of the last
+// pool_init() or pool_init_mode(), without parsing its content
+//
+// Arguments:
+//	- None
+// Returns:
+// 	- 0 if the arena has been reset, -1 if no arena was setup
+// -----------------------------------------------------------------------------------------------
+int pool_reset(void);
+
+// -----------------------------------------------------------------------------------------------
+// Returns the size of a chunk in the pool previously allocated, which may be a bit more than the
+// size requested if the block consumed a whole free block
 //
 // Arguments:
 //	- addr: the chunk's address returned by a previous pool_malloc()
 // Returns:
 // 	- the size of the chunk
 // -----------------------------------------------------------------------------------------------
-unsigned int pool_get_size(void * addr);
+pool_size_t pool_get_size(void * addr);
+
+// -----------------------------------------------------------------------------------------------
+// Maps a region twice in a row on the same memory, so a ring initialized on it with
+// POOL_MODE_RING places its blocks across the end of the region without padding. Linux only
+//
+// Arguments:
+//  - size: the size of the region, a multiple of the page size
+// Returns:
+//  - the region's first byte, NULL if it can't be mapped or a region is already mapped
+// -----------------------------------------------------------------------------------------------
+void * pool_ring_mirror(pool_size_t size);
+
+// -----------------------------------------------------------------------------------------------
+// Unmaps the region of pool_ring_mirror(), the ring initialized on it must no longer be used
+//
+// Arguments:
+//  - addr: the region's first byte
+// Returns:
+//  - 0 if the region has been unmapped, -1 otherwise
+// -----------------------------------------------------------------------------------------------
+int pool_ring_unmirror(void * addr);
+
+// Slab of fixed-size objects, placed in the arena
+typedef struct pool_slab pool_slab_t;
+
+// -----------------------------------------------------------------------------------------------
+// Creates a slab of count objects of obj_size bytes in the arena. The objects are round up to a
+// register and don't own any header
+//
+// Arguments:
+//  - obj_size: size in bytes of an object
+//  - count: number of objects to reserve
+// Returns:
+//  - the slab, NULL if the arena can't store it
+// -----------------------------------------------------------------------------------------------
+pool_slab_t * pool_slab_create(unsigned int obj_size, unsigned int count);
+
+// -----------------------------------------------------------------------------------------------
+// Allocates an object in a slab, in constant time
+//
+// Arguments:
+//  - slab: the slab to allocate from
+// Returns:
+//  - the object's address, NULL if the slab is full
+// -----------------------------------------------------------------------------------------------
+void * pool_slab_alloc(pool_slab_t * slab);
+
+// -----------------------------------------------------------------------------------------------
+// Releases an object of a slab, in constant time
+//
+// Arguments:
+//  - slab: the slab owning the object
+//  - addr: the object's address
+// Returns:
+//  - 0 if the object belongs to the slab, -1 otherwise
+// -----------------------------------------------------------------------------------------------
+int pool_slab_free(pool_slab_t * slab, void * addr);
+
+// -----------------------------------------------------------------------------------------------
+// Releases a slab and all its objects in the arena
+//
+// Arguments:
+//  - slab: the slab to release
+// Returns:
+//  - 0 if succeeded, anything otherwise
+// -----------------------------------------------------------------------------------------------
+int pool_slab_destroy(pool_slab_t * slab);
+
+// -----------------------------------------------------------------------------------------------
+// Returns the number of objects currently allocated in a slab
+//
+// Arguments:
+//  - slab: the slab to inspect
+// Returns:
+//  - the number of objects allocated
+// -----------------------------------------------------------------------------------------------
+unsigned int pool_slab_used(pool_slab_t * slab);
 
 #endif
@@ -0,0 +1,441 @@
+// distributed under the mit license
+// https://opensource.org/licenses/mit-license.php
+
+#include <stdio.h>
+#include <string.h>
+#include "pool_arena.h"
+#include "pool_engine.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// -----------------------------------------------------------------------------------------------
+// Local declarations
+// -----------------------------------------------------------------------------------------------
+
+// The blocks don't own any header, a block is a run of granules
+#define GRANULE POOL_ARENA_GRANULE
+
+// The granules start on a cache line of their own, so the bitmaps never share one with the
+// payloads, or on the natural alignment's cap if wider
+#define LINE_SIZE 64
+#define HEAP_ALIGN ((POOL_ARENA_NATURAL > LINE_SIZE) ? POOL_ARENA_NATURAL : \
+					(GRANULE > LINE_SIZE) ? GRANULE : LINE_SIZE)
+
+// Arena managed
+static void * bitmap_addr;
+static unsigned int bitmap_size;
+// First granule and the number of granules
+static char * heap;
+static unsigned int nb_gran;
+// Number of 32 bits words of each bitmap
+static unsigned int nb_word;
+
+// Two bitmaps stored at the head of the arena, one bit per granule: used flags the allocated
+// granules, last flags the last granule of each block so free() finds back the block's length
+static unsigned int * used_map;
+static unsigned int * last_map;
+
+// All the granules below are allocated, the search starts from it
+static unsigned int hint;
+
+// Used to track arena status during usage and check if no leaks occur
+static int nb_alloc_blk;
+static unsigned int alloc_space;
+static unsigned int free_space;
+
+
+static inline unsigned int map_get(unsigned int * map, unsigned int bit) {
+	return (map[bit / 32] >> (bit % 32)) & 1;
+}
+
+
+// Number of bits set in a 32 bits word
+static inline unsigned int pop_count(unsigned int x) {
+
+	#if defined(__GNUC__)
+	return __builtin_popcount(x);
+	#else
+	unsigned int cnt = 0;
+	while (x) {
+		x &= x - 1;
+		cnt++;
+	}
+	return cnt;
+	#endif
+}
+
+
+// Sets or clears the bits [from, to[ of a bitmap, a word at once
+static inline void map_range(unsigned int * map, unsigned int from, unsigned int to, int set) {
+
+	unsigned int mask;
+
+	while (from < to) {
+		mask = ~0u << (from % 32);
+		if (to - (from & ~31u) < 32)
+			mask &= (1u << (to % 32)) - 1;
+		if (set)
+			map[from / 32] |= mask;
+		else
+			map[from / 32] &= ~mask;
+		from = (from & ~31u) + 32;
+	}
+}
+
+
+// -----------------------------------------------------------------------------------------------
+// Finds the first bit of a bitmap at or after a bit whose value is the one searched. The words
+// fully set to the other value are skipped, 4 at once with SSE2.
+//
+// Arguments:
+//  - map: the bitmap to parse
+//  - bit: the first bit to check
+//  - set: 1 to search a bit set, 0 a bit cleared
+//  - limit: the bit to stop at
+// Returns:
+//  - the index of the bit found, limit if none before it
+// -----------------------------------------------------------------------------------------------
+static inline unsigned int map_find(unsigned int * map, unsigned int bit, int set,
+									unsigned int limit) {
+
+	unsigned int skip = set ? 0 : ~0u;
+	unsigned int idx = bit / 32;
+	unsigned int end = (limit + 31) / 32;
+	unsigned int word;
+
+	if (bit >= limit)
+		return limit;
+
+	// First word, masking the bits before the one requested
+	word = (map[idx] ^ skip) & (~0u << (bit % 32));
+
+	while (word == 0) {
+		idx++;
+		#if defined(__SSE2__)
+		__m128i full = _mm_set1_epi32((int)skip);
+		while (idx + 4 <= end &&
+			   _mm_movemask_epi8(_mm_cmpeq_epi32(_mm_loadu_si128((const __m128i *)&map[idx]),
+												 full)) == 0xFFFF)
+			idx += 4;
+		#endif
+		if (idx >= end)
+			return limit;
+		word = map[idx] ^ skip;
+	}
+
+	bit = idx * 32 + find_first_set(word);
+	return (bit < limit) ? bit : limit;
+}
+
+
+// -----------------------------------------------------------------------------------------------
+// Setups the bitmaps at the head of the arena, then the granules in the remaining space
+//
+// Arguments:
+//  - addr: address of the arena's first byte
+//  - size: size in byte available for the arena
+// Returns:
+//  - -1 if size is too small to contain at least 1 granule, otherwise 0
+// -----------------------------------------------------------------------------------------------
+static int bitmap_init(void * addr, unsigned int size) {
+
+	char * end = (char *)addr + size;
+	unsigned int map_size;
+
+	// A granule costs GRANULE bytes and 2 bits, each bitmap being made of 32 bits words
+	nb_gran = (unsigned int)(((unsigned long long)size * 8) / (8 * GRANULE + 2));
+	nb_word = (nb_gran + 31) / 32;
+	map_size = nb_word * sizeof(unsigned int);
+	used_map = addr;
+	last_map = used_map + nb_word;
+
+	heap = (char *)addr + 2 * map_size;
+	heap += (HEAP_ALIGN - ((size_t)heap % HEAP_ALIGN)) % HEAP_ALIGN;
+	if (heap >= end)
+		return -1;
+	if ((unsigned int)(end - heap) / GRANULE < nb_gran)
+		nb_gran = (unsigned int)(end - heap) / GRANULE;
+	if (nb_gran == 0)
+		return -1;
+
+	bitmap_addr = addr;
+	bitmap_size = size;
+	memset(used_map, 0, 2 * map_size);
+	// The bits beyond the last granule are flagged used, so never selected
+	map_range(used_map, nb_gran, nb_word * 32, 1);
+	hint = 0;
+	nb_alloc_blk = 0;
+	alloc_space = 0;
+	free_space = nb_gran * GRANULE;
+
+    #ifdef POOL_ARENA_DEBUG
+    printf("Bitmap Setup:\n");
+    printf("  - bitmaps: %d bytes\n", 2 * map_size);
+    printf("  - granules addr: %p\n", (void *)heap);
+    printf("  - granules: %d of %d bytes\n", nb_gran, GRANULE);
+	printf("------------------------------------------------------------------------\n");
+    #endif
+
+	return 0;
+}
+
+
+// Alignment in granules of a block of nb granules: the largest power of two not above its size,
+// capped by POOL_ARENA_NATURAL, or a granule without natural alignment
+static inline unsigned int bitmap_align(unsigned int nb) {
+
+	#if POOL_ARENA_NATURAL > GRANULE
+	unsigned int align = 1u << find_last_set(nb);
+
+	return (align < POOL_ARENA_NATURAL / GRANULE) ? align : POOL_ARENA_NATURAL / GRANULE;
+	#else
+	(void)nb;
+	return 1;
+	#endif
+}
+
+
+// -----------------------------------------------------------------------------------------------
+// Allocates the first run of free granules wide enough. The search jumps from a free granule to
+// the next used one and from a used granule to the next free one, parsing the bitmap a word at
+// once, so a run of allocated or free granules costs a find-first-set per word. With
+// POOL_ARENA_NATURAL, the run starts on the block's natural alignment.
+//
+// Argument:
+//  - size: the number of bytes the block needs to own
+// Returns:
+//  - the address of the buffer's first byte, NULL if failed
+// -----------------------------------------------------------------------------------------------
+static void * bitmap_alloc(unsigned int size) {
+
+	unsigned int nb;
+	unsigned int align;
+	unsigned int start;
+	unsigned int stop;
+
+	if (size == 0 || size > nb_gran * GRANULE) {
+		#ifdef POOL_ARENA_DEBUG
+        printf("ERROR: Can't allocate a %d bytes block\n", size);
+		#endif
+		return NULL;
+	}
+
+	nb = (size + GRANULE - 1) / GRANULE;
+	align = bitmap_align(nb);
+	start = map_find(used_map, hint, 0, nb_gran);
+
+	while (start + nb <= nb_gran) {
+		start = (start + align - 1) & ~(align - 1);
+		if (start + nb > nb_gran)
+			break;
+		stop = map_find(used_map, start, 1, start + nb);
+		if (stop == start + nb)
+			break;
+		start = map_find(used_map, stop, 0, nb_gran);
+	}
+
+	if (start + nb > nb_gran) {
+		#ifdef POOL_ARENA_DEBUG
+		printf("ERROR: Can't find a enough space to store a new block\n");
+		printf("  - requested free space: %d\n", size);
+		printf("  - current free space: %d\n", free_space);
+		#endif
+		return NULL;
+	}
+
+	map_range(used_map, start, start + nb, 1);
+	last_map[(start + nb - 1) / 32] |= 1u << ((start + nb - 1) % 32);
+	if (start == hint)
+		hint = start + nb;
+
+	nb_alloc_blk += 1;
+	alloc_space += nb * GRANULE;
+	free_space -= nb * GRANULE;
+
+	#ifdef POOL_ARENA_DEBUG
+	printf("  - allocated addr: %p\n", (void *)(heap + start * GRANULE));
+	printf("  - granules: %d\n", nb);
+	printf("------------------------------------------------------------------------\n");
+	#endif
+
+	return heap + start * GRANULE;
+}
+
+
+// Granule of the first byte of an allocated block, nb_gran if addr is not one
+static inline unsigned int bitmap_granule(void * addr) {
+
+	unsigned int gran;
+
+	if ((char *)addr < heap || (char *)addr >= heap + nb_gran * GRANULE ||
+		((char *)addr - heap) % GRANULE != 0)
+		return nb_gran;
+
+	gran = (unsigned int)((char *)addr - heap) / GRANULE;
+	// The previous granule must be free or the last one of another block
+	if (!map_get(used_map, gran) ||
+		(gran > 0 && map_get(used_map, gran - 1) && !map_get(last_map, gran - 1)))
+		return nb_gran;
+
+	return gran;
+}
+
+
+// -----------------------------------------------------------------------------------------------
+// Releases a block: its granules are cleared in the bitmaps, nothing to merge
+//
+// Arguments:
+//  - addr: the address of the data block
+// Returns:
+//  - 0 if block has been released, -1 if the address is not an allocated block
+// -----------------------------------------------------------------------------------------------
+static int bitmap_release(void * addr) {
+
+	unsigned int start = bitmap_granule(addr);
+	unsigned int last;
+
+	if (start == nb_gran) {
+		#ifdef POOL_ARENA_DEBUG
+		printf("ERROR: %p is not an allocated block\n", addr);
+		#endif
+		return -1;
+	}
+
+	last = map_find(last_map, start, 1, nb_gran);
+
+	#ifdef POOL_ARENA_DEBUG
+	printf("  - addr to free: %p\n", addr);
+	printf("  - granules: %d\n", last - start + 1);
+	#endif
+
+	map_range(used_map, start, last + 1, 0);
+	last_map[last / 32] &= ~(1u << (last % 32));
+	if (start < hint)
+		hint = start;
+
+	nb_alloc_blk -= 1;
+	alloc_space -= (last - start + 1) * GRANULE;
+	free_space += (last - start + 1) * GRANULE;
+
+	#ifdef POOL_ARENA_DEBUG
+	printf("------------------------------------------------------------------------\n");
+	#endif
+
+	return 0;
+}
+
+
+// Return the size of chunk located @ address
+static unsigned int bitmap_get_size(void * addr) {
+
+	unsigned int start = (unsigned int)((char *)addr - heap) / GRANULE;
+
+	return (map_find(last_map, start, 1, nb_gran) - start + 1) * GRANULE;
+}
+
+
+// -----------------------------------------------------------------------------------------------
+// Checks the bitmaps match the statistics: the granules used and the blocks' ends are counted
+// with a population count per word
+//
+// Arguments:
+//	- None
+// Returns:
+// 	- 1 if space range is not equal to initial setup, 0 otherwise
+// -----------------------------------------------------------------------------------------------
+static int bitmap_check(void) {
+
+	unsigned int used = 0;
+	unsigned int ends = 0;
+	int err = 0;
+
+	for (unsigned int i = 0; i < nb_word; i++) {
+		used += pop_count(used_map[i]);
+		ends += pop_count(last_map[i]);
+		// A block's end is always a used granule
+		if (last_map[i] & ~used_map[i])
+			err = 1;
+	}
+	// The padding bits are flagged used
+	used -= nb_word * 32 - nb_gran;
+
+	// A used granule followed by a free one is the end of a block
+	for (unsigned int i = 0; i + 1 < nb_gran; i++) {
+		if (map_get(used_map, i) && !map_get(used_map, i + 1) && !map_get(last_map, i))
+			err = 1;
+	}
+	if (nb_gran > 0 && map_get(used_map, nb_gran - 1) && !map_get(last_map, nb_gran - 1))
+		err = 1;
+	if (map_find(used_map, 0, 0, nb_gran) < hint)
+		err = 1;
+
+	#ifdef POOL_ARENA_DEBUG
+	printf("\n");
+	printf("------------------------------------------------------------------------\n");
+	printf("Pool Check (Bitmap)\n");
+	printf("------------------------------------------------------------------------\n");
+	printf("Granules space: %d\n", nb_gran * GRANULE);
+	printf("  - nb alloc space: %d\n", nb_alloc_blk);
+	printf("  - counted nb alloc space: %d\n", ends);
+	printf("  - alloc space: %d\n", alloc_space);
+	printf("  - counted alloc space: %d\n", used * GRANULE);
+	printf("  - free space: %d\n", free_space);
+	printf("Granules vs Computed: %d\n", nb_gran * GRANULE - alloc_space - free_space);
+	printf("------------------------------------------------------------------------\n");
+	#endif
+
+	if (err || ends != (unsigned int)nb_alloc_blk || used * GRANULE != alloc_space ||
+		nb_gran * GRANULE != alloc_space + free_space) {
+		#ifdef POOL_ARENA_DEBUG
+		printf("ERROR: Bitmaps don't match the allocated space\n");
+		printf("------------------------------------------------------------------------\n");
+		#endif
+		return 1;
+	}
+
+	return 0;
+}
+
+
+// Print the allocated blocks, found back by parsing the runs of used granules
+static void bitmap_log(void) {
+
+	unsigned int start;
+	unsigned int last;
+
+	printf("\n");
+	printf("------------------------------------------------------------------------\n");
+	printf("Pool Arena (Bitmap)\n");
+	printf("------------------------------------------------------------------------\n");
+	printf("Addr: %p\t", bitmap_addr);
+	printf("Size: %d\t", bitmap_size);
+	printf("Granules: %p\t", (void *)heap);
+	printf("Nb Granules: %d\t", nb_gran);
+	printf("\n");
+	printf("------------------------------------------------------------------------\n");
+	printf("Allocated Blocks\n");
+	printf("------------------------------------------------------------------------\n");
+	start = map_find(used_map, 0, 1, nb_gran);
+	while (start < nb_gran) {
+		last = map_find(last_map, start, 1, nb_gran);
+		printf("Addr: %p\t", (void *)(heap + start * GRANULE));
+		printf("Granules: %d\t", last - start + 1);
+		printf("Size: %d\t", (last - start + 1) * GRANULE);
+		printf("\n");
+		start = map_find(used_map, last + 1, 1, nb_gran);
+	}
+	printf("------------------------------------------------------------------------\n");
+	printf("\n");
+}
+
+
+const pool_engine_t bitmap_engine = {
+	bitmap_init,
+	bitmap_alloc,
+	bitmap_release,
+	bitmap_get_size,
+	bitmap_check,
+	bitmap_log
+};
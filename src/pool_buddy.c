@@ -0,0 +1,451 @@
+// distributed under the mit license
+// https://opensource.org/licenses/mit-license.php
+
+#include <stdio.h>
+#include <string.h>
+#include "pool_arena.h"
+#include "pool_engine.h"
+
+// -----------------------------------------------------------------------------------------------
+// Local declarations
+// -----------------------------------------------------------------------------------------------
+
+// A free block of the buddy engine, only storing the links of its order's free list. The
+// allocated blocks don't own any header, their order is found back with the split bitmap.
+struct buddy_blk {
+    // Pointer to the previous free block of the order
+    struct buddy_blk * prv;
+    // Pointer to the next free block of the order
+    struct buddy_blk * nxt;
+};
+
+typedef struct buddy_blk buddy_blk_t;
+
+// Number of orders supported, the tree can cover up to 2^31 bytes
+#define NB_ORDER 32
+// Alignment of the first block of the tree
+#define BUDDY_ALIGN 64
+
+// Size of a memory element, 32 or 64 bits
+static const unsigned int reg_size = sizeof(void *);
+
+// Arena managed
+static void * buddy_addr;
+static unsigned int buddy_size;
+// First byte of the tree and its size. The tree covers 2^max_order bytes, the nodes above
+// heap_size are never released so never merged.
+static char * heap;
+static unsigned int heap_size;
+// Smallest block: the free list links. Widest block: the whole tree
+static unsigned int min_order;
+static unsigned int max_order;
+
+// One bit per node of the tree, stored at the head of the arena. A node is flagged free if
+// chained in its order's free list, split if forked in two buddies
+static unsigned char * free_map;
+static unsigned char * split_map;
+
+// Free lists per order and the bitmap flagging the non-empty ones
+static buddy_blk_t * lists[NB_ORDER];
+static unsigned int list_map;
+
+// Used to track arena status during usage and check if no leaks occur
+static int nb_free_blk[NB_ORDER];
+static int nb_alloc_blk[NB_ORDER];
+static unsigned int alloc_space;
+static unsigned int free_space;
+
+
+// Index of the node of an order containing an offset, the root being the node 0
+static inline unsigned int node(unsigned int order, unsigned int off) {
+	return (1u << (max_order - order)) - 1 + (off >> order);
+}
+
+
+static inline int map_get(unsigned char * map, unsigned int order, unsigned int off) {
+	unsigned int n = node(order, off);
+	return (map[n / 8] >> (n % 8)) & 1;
+}
+
+
+static inline void map_set(unsigned char * map, unsigned int order, unsigned int off) {
+	unsigned int n = node(order, off);
+	map[n / 8] |= 1u << (n % 8);
+}
+
+
+static inline void map_clr(unsigned char * map, unsigned int order, unsigned int off) {
+	unsigned int n = node(order, off);
+	map[n / 8] &= ~(1u << (n % 8));
+}
+
+
+// Smallest order able to store size bytes
+static inline unsigned int ceil_order(unsigned int size) {
+	return (size <= 1) ? 0 : find_last_set(size - 1) + 1;
+}
+
+
+// Chain a block in its order's free list
+static inline void buddy_push(unsigned int order, unsigned int off) {
+
+	buddy_blk_t * blk = (buddy_blk_t *)(heap + off);
+
+	blk->prv = NULL;
+	blk->nxt = lists[order];
+	if (blk->nxt != NULL)
+		blk->nxt->prv = blk;
+	lists[order] = blk;
+	list_map |= 1u << order;
+	map_set(free_map, order, off);
+	nb_free_blk[order] += 1;
+	free_space += 1u << order;
+}
+
+
+// Unchain a block from its order's free list
+static inline void buddy_remove(unsigned int order, unsigned int off) {
+
+	buddy_blk_t * blk = (buddy_blk_t *)(heap + off);
+
+	if (blk->prv != NULL)
+		blk->prv->nxt = blk->nxt;
+	else
+		lists[order] = blk->nxt;
+	if (blk->nxt != NULL)
+		blk->nxt->prv = blk->prv;
+	if (lists[order] == NULL)
+		list_map &= ~(1u << order);
+	map_clr(free_map, order, off);
+	nb_free_blk[order] -= 1;
+	free_space -= 1u << order;
+}
+
+
+// Order of the allocated block starting at offset, found by descending the split nodes
+static inline unsigned int buddy_order(unsigned int off) {
+
+	unsigned int order = max_order;
+
+	while (order > min_order && map_get(split_map, order, off))
+		order--;
+	return order;
+}
+
+
+// -----------------------------------------------------------------------------------------------
+// Releases the nodes of the tree inside the arena: a node fully inside is chained as free, a node
+// across the arena's end is split and its children are carved
+//
+// Arguments:
+//  - order: the node's order
+//  - off: the node's offset in the tree
+// Returns:
+//  - nothing
+// -----------------------------------------------------------------------------------------------
+static void buddy_carve(unsigned int order, unsigned int off) {
+
+	if (off >= heap_size)
+		return;
+
+	if (off + (1u << order) <= heap_size) {
+		buddy_push(order, off);
+		return;
+	}
+
+	map_set(split_map, order, off);
+	buddy_carve(order - 1, off);
+	buddy_carve(order - 1, off + (1u << (order - 1)));
+}
+
+
+// -----------------------------------------------------------------------------------------------
+// Setups the bitmaps at the head of the arena, then the tree in the remaining space
+//
+// Arguments:
+//  - addr: address of the arena's first byte
+//  - size: size in byte available for the arena
+// Returns:
+//  - -1 if size is too small to contain at least 1 block, otherwise 0
+// -----------------------------------------------------------------------------------------------
+static int buddy_init(void * addr, unsigned int size) {
+
+	unsigned int nb_node;
+	unsigned int map_size;
+	char * end = (char *)addr + size;
+
+	min_order = find_last_set(2 * reg_size);
+	max_order = ceil_order(size);
+	if (max_order >= NB_ORDER)
+		max_order = NB_ORDER - 1;
+	if (max_order <= min_order)
+		return -1;
+
+	// Bitmaps sized for a tree covering the whole arena
+	nb_node = (2u << (max_order - min_order)) - 1;
+	map_size = (nb_node + 7) / 8;
+	free_map = addr;
+	split_map = (unsigned char *)addr + map_size;
+
+	heap = (char *)addr + 2 * map_size;
+	heap += (BUDDY_ALIGN - ((size_t)heap % BUDDY_ALIGN)) % BUDDY_ALIGN;
+	if (heap >= end)
+		return -1;
+	heap_size = (unsigned int)(end - heap) & ~((1u << min_order) - 1);
+	if (heap_size > 1u << (NB_ORDER - 1))
+		heap_size = 1u << (NB_ORDER - 1);
+	if (heap_size == 0)
+		return -1;
+
+	// The tree only needs to cover the remaining space
+	max_order = ceil_order(heap_size);
+	if (max_order < min_order)
+		max_order = min_order;
+
+	buddy_addr = addr;
+	buddy_size = size;
+	memset(free_map, 0, 2 * map_size);
+	memset(lists, 0, sizeof(lists));
+	memset(nb_free_blk, 0, sizeof(nb_free_blk));
+	memset(nb_alloc_blk, 0, sizeof(nb_alloc_blk));
+	list_map = 0;
+	alloc_space = 0;
+	free_space = 0;
+
+	buddy_carve(max_order, 0);
+
+    #ifdef POOL_ARENA_DEBUG
+    printf("Buddy Setup:\n");
+    printf("  - bitmaps: %d bytes\n", 2 * map_size);
+    printf("  - tree addr: %p\n", (void *)heap);
+    printf("  - tree size: %d bytes\n", heap_size);
+    printf("  - orders: %d to %d\n", min_order, max_order);
+	printf("------------------------------------------------------------------------\n");
+    #endif
+
+	return 0;
+}
+
+
+// -----------------------------------------------------------------------------------------------
+// Allocates a block of the smallest order able to store size bytes. The first non-empty order
+// is found with the bitmap, then the block is split down to the order requested, releasing
+// each right buddy.
+//
+// Argument:
+//  - size: the number of bytes the block needs to own
+// Returns:
+//  - the address of the buffer's first byte, NULL if failed
+// -----------------------------------------------------------------------------------------------
+static void * buddy_alloc(unsigned int size) {
+
+	unsigned int order;
+	unsigned int found;
+	unsigned int map;
+	unsigned int off;
+
+	if (size == 0 || size > 1u << max_order) {
+		#ifdef POOL_ARENA_DEBUG
+        printf("ERROR: Can't allocate a %d bytes block\n", size);
+		#endif
+		return NULL;
+	}
+
+	order = ceil_order(size);
+	if (order < min_order)
+		order = min_order;
+
+	map = list_map & (~0u << order);
+	if (map == 0) {
+		#ifdef POOL_ARENA_DEBUG
+		printf("ERROR: Can't find a enough space to store a new block\n");
+		printf("  - requested free space: %d\n", size);
+		printf("  - current free space: %d\n", free_space);
+		#endif
+		return NULL;
+	}
+
+	found = find_first_set(map);
+	off = (unsigned int)((char *)lists[found] - heap);
+	buddy_remove(found, off);
+
+	while (found > order) {
+		map_set(split_map, found, off);
+		found--;
+		buddy_push(found, off + (1u << found));
+	}
+
+	nb_alloc_blk[order] += 1;
+	alloc_space += 1u << order;
+
+	#ifdef POOL_ARENA_DEBUG
+	printf("  - allocated addr: %p\n", (void *)(heap + off));
+	printf("  - order: %d\n", order);
+	printf("------------------------------------------------------------------------\n");
+	#endif
+
+	return heap + off;
+}
+
+
+// -----------------------------------------------------------------------------------------------
+// Releases a block and merges it with its buddy as long as this one is free
+//
+// Arguments:
+//  - addr: the address of the data block
+// Returns:
+//  - 0 if block has been released, -1 if the address is not an allocated block
+// -----------------------------------------------------------------------------------------------
+static int buddy_release(void * addr) {
+
+	unsigned int off;
+	unsigned int order;
+	unsigned int buddy;
+
+	if ((char *)addr < heap || (char *)addr >= heap + heap_size) {
+		#ifdef POOL_ARENA_DEBUG
+		printf("ERROR: %p is not in the buddy tree\n", addr);
+		#endif
+		return -1;
+	}
+
+	off = (unsigned int)((char *)addr - heap);
+	order = buddy_order(off);
+	if ((off & ((1u << order) - 1)) != 0 || map_get(free_map, order, off)) {
+		#ifdef POOL_ARENA_DEBUG
+		printf("ERROR: %p is not an allocated block\n", addr);
+		#endif
+		return -1;
+	}
+
+	#ifdef POOL_ARENA_DEBUG
+	printf("  - addr to free: %p\n", addr);
+	printf("  - order: %d\n", order);
+	#endif
+
+	nb_alloc_blk[order] -= 1;
+	alloc_space -= 1u << order;
+
+	while (order < max_order) {
+		buddy = off ^ (1u << order);
+		if (!map_get(free_map, order, buddy))
+			break;
+		buddy_remove(order, buddy);
+		off &= ~(1u << order);
+		order++;
+		map_clr(split_map, order, off);
+	}
+	buddy_push(order, off);
+
+	#ifdef POOL_ARENA_DEBUG
+	printf("  - merged up to order: %d\n", order);
+	printf("------------------------------------------------------------------------\n");
+	#endif
+
+	return 0;
+}
+
+
+// Return the size of chunk located @ address
+static unsigned int buddy_get_size(void * addr) {
+	return 1u << buddy_order((unsigned int)((char *)addr - heap));
+}
+
+
+// -----------------------------------------------------------------------------------------------
+// Checks the free lists match the bitmaps and the statistics
+//
+// Arguments:
+//	- None
+// Returns:
+// 	- 1 if space range is not equal to initial setup, 0 otherwise
+// -----------------------------------------------------------------------------------------------
+static int buddy_check(void) {
+
+	unsigned int alloc = 0;
+	unsigned int free = 0;
+	int err = 0;
+	int cnt;
+	buddy_blk_t * blk;
+	unsigned int off;
+
+	for (unsigned int order = min_order; order <= max_order; order++) {
+		cnt = 0;
+		for (blk = lists[order]; blk != NULL; blk = blk->nxt) {
+			off = (unsigned int)((char *)blk - heap);
+			if ((off & ((1u << order) - 1)) != 0 || !map_get(free_map, order, off))
+				err = 1;
+			cnt += 1;
+		}
+		if (cnt != nb_free_blk[order] || (lists[order] != NULL) != ((list_map >> order) & 1))
+			err = 1;
+		free += (unsigned int)nb_free_blk[order] << order;
+		alloc += (unsigned int)nb_alloc_blk[order] << order;
+	}
+
+	#ifdef POOL_ARENA_DEBUG
+	printf("\n");
+	printf("------------------------------------------------------------------------\n");
+	printf("Pool Check (Buddy)\n");
+	printf("------------------------------------------------------------------------\n");
+	printf("Tree space: %d\n", heap_size);
+	printf("  - alloc space: %d\n", alloc_space);
+	printf("  - free space: %d\n", free_space);
+	for (unsigned int order = min_order; order <= max_order; order++) {
+		if (nb_free_blk[order] || nb_alloc_blk[order])
+			printf("  - order %d (%d bytes): %d free, %d allocated\n", order, 1u << order,
+					nb_free_blk[order], nb_alloc_blk[order]);
+	}
+	printf("Tree vs Computed: %d\n", heap_size - alloc - free);
+	printf("------------------------------------------------------------------------\n");
+	#endif
+
+	if (err || alloc != alloc_space || free != free_space || heap_size != alloc + free) {
+		#ifdef POOL_ARENA_DEBUG
+		printf("ERROR: Free space doesn't match\n");
+		printf("------------------------------------------------------------------------\n");
+		#endif
+		return 1;
+	}
+
+	return 0;
+}
+
+
+// Print the occupancy and the free blocks per order
+static void buddy_log(void) {
+
+	buddy_blk_t * blk;
+
+	printf("\n");
+	printf("------------------------------------------------------------------------\n");
+	printf("Pool Arena (Buddy)\n");
+	printf("------------------------------------------------------------------------\n");
+	printf("Addr: %p\t", buddy_addr);
+	printf("Size: %d\t", buddy_size);
+	printf("Tree: %p\t", (void *)heap);
+	printf("Tree Size: %d\t", heap_size);
+	printf("\n");
+	printf("------------------------------------------------------------------------\n");
+	printf("Orders\n");
+	printf("------------------------------------------------------------------------\n");
+	for (unsigned int order = min_order; order <= max_order; order++) {
+		printf("Order: %d\tSize: %d\tFree: %d\tAllocated: %d\t", order, 1u << order,
+				nb_free_blk[order], nb_alloc_blk[order]);
+		for (blk = lists[order]; blk != NULL; blk = blk->nxt)
+			printf("%p ", (void *)blk);
+		printf("\n");
+	}
+	printf("------------------------------------------------------------------------\n");
+	printf("\n");
+}
+
+
+const pool_engine_t buddy_engine = {
+	buddy_init,
+	buddy_alloc,
+	buddy_release,
+	buddy_get_size,
+	buddy_check,
+	buddy_log
+};
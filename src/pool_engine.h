@@ -0,0 +1,65 @@
+// distributed under the mit license
+// https://opensource.org/licenses/mit-license.php
+
+#ifndef POOL_ENGINE_INCLUDE
+#define POOL_ENGINE_INCLUDE
+
+// -----------------------------------------------------------------------------------------------
+// Internal interface between the pool arena API and the allocation engines managing the arena on
+// their own. The list engine's modes are implemented directly in pool_arena.c, the other
+// engines provide these functions, with the same arguments and returns than the pool_*() API.
+// -----------------------------------------------------------------------------------------------
+
+typedef struct pool_engine {
+	int (*init)(void * addr, unsigned int size);
+	void * (*alloc)(unsigned int size);
+	int (*release)(void * addr);
+	unsigned int (*get_size)(void * addr);
+	int (*check)(void);
+	void (*log)(void);
+} pool_engine_t;
+
+// Two-level segregated fit engine, pool_tlsf.c
+extern const pool_engine_t tlsf_engine;
+// Binary buddy engine, pool_buddy.c
+extern const pool_engine_t buddy_engine;
+// Granules' bitmap engine, pool_bitmap.c
+extern const pool_engine_t bitmap_engine;
+// FIFO ring engine, pool_ring.c
+extern const pool_engine_t ring_engine;
+
+
+// -----------------------------------------------------------------------------------------------
+// Returns the index of the first bit set in a 32 bits word, x can't be zero
+// -----------------------------------------------------------------------------------------------
+static inline unsigned int find_first_set(unsigned int x) {
+
+	#if defined(__GNUC__)
+	return __builtin_ctz(x);
+	#else
+	unsigned int i = 0;
+	while ((x & 1) == 0) {
+		x >>= 1;
+		i++;
+	}
+	return i;
+	#endif
+}
+
+
+// -----------------------------------------------------------------------------------------------
+// Returns the index of the last bit set in a 32 bits word, x can't be zero
+// -----------------------------------------------------------------------------------------------
+static inline unsigned int find_last_set(unsigned int x) {
+
+	#if defined(__GNUC__)
+	return 31 - __builtin_clz(x);
+	#else
+	unsigned int i = 0;
+	while (x >>= 1)
+		i++;
+	return i;
+	#endif
+}
+
+#endif
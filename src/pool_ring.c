@@ -0,0 +1,432 @@
+// distributed under the mit license
+// https://opensource.org/licenses/mit-license.php
+
+#if defined(__linux__)
+#define _GNU_SOURCE
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include <stdio.h>
+#include <string.h>
+#include "pool_arena.h"
+#include "pool_engine.h"
+
+// -----------------------------------------------------------------------------------------------
+// Local declarations
+// -----------------------------------------------------------------------------------------------
+
+// Header of a block of the ring: the size of its payload and if it's still in use. A block
+// released out of order stays in the ring until all the blocks before it are released too.
+struct ring_blk {
+	unsigned int size;
+	unsigned int live;
+};
+
+typedef struct ring_blk ring_blk_t;
+
+// The blocks are multiple of the header, so a header never straddles the end of the ring
+#define RING_ALIGN sizeof(ring_blk_t)
+
+// Arena managed
+static void * ring_addr;
+static unsigned int ring_size;
+// First byte of the ring and its capacity
+static char * heap;
+static unsigned int cap;
+// Offset of the oldest block, of the next block, and the bytes between them, padding included
+static unsigned int head;
+static unsigned int tail;
+static unsigned int used;
+// The ring is mapped twice in a row, a block can wrap around its end
+static int mirrored;
+
+// Region mapped twice by pool_ring_mirror(), the ring initialized on it is mirrored
+static void * mirror_addr;
+static unsigned int mirror_size;
+
+// Used to track arena status during usage and check if no leaks occur
+static int nb_alloc_blk;
+static unsigned int alloc_space;
+
+
+static inline ring_blk_t * ring_blk(unsigned int off) {
+	return (ring_blk_t *)(heap + off);
+}
+
+
+// -----------------------------------------------------------------------------------------------
+// Setups the ring over the whole arena, its state being kept out of it
+//
+// Arguments:
+//  - addr: address of the arena's first byte
+//  - size: size in byte available for the arena
+// Returns:
+//  - -1 if size is too small to contain at least 1 block, otherwise 0
+// -----------------------------------------------------------------------------------------------
+static int ring_init(void * addr, unsigned int size) {
+
+	unsigned int pad = (RING_ALIGN - ((size_t)addr % RING_ALIGN)) % RING_ALIGN;
+
+	if (size <= pad + RING_ALIGN)
+		return -1;
+
+	ring_addr = addr;
+	ring_size = size;
+	mirrored = (mirror_addr != NULL && addr == mirror_addr && size == mirror_size);
+	heap = (char *)addr + pad;
+	cap = (size - pad) & ~(unsigned int)(RING_ALIGN - 1);
+	head = 0;
+	tail = 0;
+	used = 0;
+	nb_alloc_blk = 0;
+	alloc_space = 0;
+
+    #ifdef POOL_ARENA_DEBUG
+    printf("Ring Setup:\n");
+    printf("  - ring addr: %p\n", (void *)heap);
+    printf("  - capacity: %d bytes\n", cap);
+    printf("  - mirrored: %s\n", mirrored ? "yes" : "no");
+	printf("------------------------------------------------------------------------\n");
+    #endif
+
+	return 0;
+}
+
+
+// -----------------------------------------------------------------------------------------------
+// Allocates a block at the tail of the ring. If the space up to the end of the ring is too
+// narrow, it's padded and the block is placed at the start, unless the ring is mirrored: the
+// block then wraps around the end and stays contiguous in the second mapping.
+//
+// Argument:
+//  - size: the number of bytes the block needs to own
+// Returns:
+//  - the address of the buffer's first byte, NULL if failed
+// -----------------------------------------------------------------------------------------------
+static void * ring_alloc(unsigned int size) {
+
+	unsigned int need = (size + 2 * RING_ALIGN - 1) & ~(unsigned int)(RING_ALIGN - 1);
+	ring_blk_t * blk;
+
+	if (size == 0 || need < size || need > cap - used) {
+		#ifdef POOL_ARENA_DEBUG
+		printf("ERROR: Can't find a enough space to store a new block\n");
+		printf("  - requested free space: %d\n", size);
+		printf("  - current free space: %d\n", cap - used);
+		#endif
+		return NULL;
+	}
+
+	if (!mirrored && tail >= head && need > cap - tail) {
+		// The block doesn't fit before the end, the end is padded by a block already released
+		if (need > head) {
+			#ifdef POOL_ARENA_DEBUG
+			printf("ERROR: Can't store a %d bytes block before the head\n", size);
+			#endif
+			return NULL;
+		}
+		blk = ring_blk(tail);
+		blk->size = cap - tail - RING_ALIGN;
+		blk->live = 0;
+		used += cap - tail;
+		tail = 0;
+	} else if (!mirrored && tail < head && need > head - tail) {
+		#ifdef POOL_ARENA_DEBUG
+		printf("ERROR: Can't store a %d bytes block before the head\n", size);
+		#endif
+		return NULL;
+	}
+
+	blk = ring_blk(tail);
+	blk->size = need - RING_ALIGN;
+	blk->live = 1;
+	tail += need;
+	if (tail >= cap)
+		tail -= cap;
+	used += need;
+
+	nb_alloc_blk += 1;
+	alloc_space += blk->size;
+
+	#ifdef POOL_ARENA_DEBUG
+	printf("  - allocated addr: %p\n", (void *)(blk + 1));
+	printf("  - size: %d\n", blk->size);
+	printf("------------------------------------------------------------------------\n");
+	#endif
+
+	return blk + 1;
+}
+
+
+// Offset of the header of an allocated block, cap if addr is not one
+static inline unsigned int ring_offset(void * addr) {
+
+	unsigned int off;
+
+	if ((char *)addr < heap + RING_ALIGN || (char *)addr > heap + cap ||
+		((char *)addr - heap) % RING_ALIGN != 0)
+		return cap;
+
+	off = (unsigned int)((char *)addr - heap) - RING_ALIGN;
+	return (ring_blk(off)->live == 1) ? off : cap;
+}
+
+
+// -----------------------------------------------------------------------------------------------
+// Releases a block. The head of the ring moves over the block if it's the oldest one, then over
+// the blocks following it already released, so a block released out of order is reclaimed
+// when all the blocks allocated before it are released too.
+//
+// Arguments:
+//  - addr: the address of the data block
+// Returns:
+//  - 0 if block has been released, -1 if the address is not an allocated block
+// -----------------------------------------------------------------------------------------------
+static int ring_release(void * addr) {
+
+	unsigned int off = ring_offset(addr);
+	unsigned int span;
+
+	if (off == cap) {
+		#ifdef POOL_ARENA_DEBUG
+		printf("ERROR: %p is not an allocated block\n", addr);
+		#endif
+		return -1;
+	}
+
+	#ifdef POOL_ARENA_DEBUG
+	printf("  - addr to free: %p\n", addr);
+	printf("  - size to free: %d\n", ring_blk(off)->size);
+	printf("  - deferred: %s\n", (off != head) ? "yes" : "no");
+	#endif
+
+	ring_blk(off)->live = 0;
+	nb_alloc_blk -= 1;
+	alloc_space -= ring_blk(off)->size;
+
+	while (used > 0 && !ring_blk(head)->live) {
+		span = ring_blk(head)->size + RING_ALIGN;
+		used -= span;
+		head += span;
+		if (head >= cap)
+			head -= cap;
+	}
+	// Empty, the next block starts back from the beginning
+	if (used == 0) {
+		head = 0;
+		tail = 0;
+	}
+
+	#ifdef POOL_ARENA_DEBUG
+	printf("------------------------------------------------------------------------\n");
+	#endif
+
+	return 0;
+}
+
+
+// Return the size of chunk located @ address
+static unsigned int ring_get_size(void * addr) {
+	return ((ring_blk_t *)addr - 1)->size;
+}
+
+
+// -----------------------------------------------------------------------------------------------
+// Checks the blocks between the head and the tail match the statistics: the oldest block is in
+// use and the last one ends on the tail
+//
+// Arguments:
+//	- None
+// Returns:
+// 	- 1 if space range is not equal to initial setup, 0 otherwise
+// -----------------------------------------------------------------------------------------------
+static int ring_check(void) {
+
+	unsigned int off = head;
+	unsigned int left = used;
+	unsigned int span;
+	unsigned int space = 0;
+	int cnt = 0;
+	int err = 0;
+
+	if (used > 0 && !ring_blk(head)->live)
+		err = 1;
+
+	while (left > 0 && !err) {
+		span = ring_blk(off)->size + RING_ALIGN;
+		// Only a mirrored ring has a block wrapping around its end
+		if (span > left || (!mirrored && off + span > cap))
+			err = 1;
+		if (ring_blk(off)->live) {
+			cnt += 1;
+			space += ring_blk(off)->size;
+		}
+		left -= span;
+		off += span;
+		if (off >= cap)
+			off -= cap;
+	}
+	if (off != tail)
+		err = 1;
+
+	#ifdef POOL_ARENA_DEBUG
+	printf("\n");
+	printf("------------------------------------------------------------------------\n");
+	printf("Pool Check (Ring)\n");
+	printf("------------------------------------------------------------------------\n");
+	printf("Ring space: %d\n", cap);
+	printf("  - head: %d\n", head);
+	printf("  - tail: %d\n", tail);
+	printf("  - used space: %d\n", used);
+	printf("  - nb alloc space: %d\n", nb_alloc_blk);
+	printf("  - counted nb alloc space: %d\n", cnt);
+	printf("  - alloc space: %d\n", alloc_space);
+	printf("  - counted alloc space: %d\n", space);
+	printf("------------------------------------------------------------------------\n");
+	#endif
+
+	if (err || cnt != nb_alloc_blk || space != alloc_space || used > cap) {
+		#ifdef POOL_ARENA_DEBUG
+		printf("ERROR: Ring doesn't match the allocated space\n");
+		printf("------------------------------------------------------------------------\n");
+		#endif
+		return 1;
+	}
+
+	return 0;
+}
+
+
+// Print the blocks from the head to the tail of the ring
+static void ring_log(void) {
+
+	unsigned int off = head;
+	unsigned int left = used;
+	unsigned int span;
+
+	printf("\n");
+	printf("------------------------------------------------------------------------\n");
+	printf("Pool Arena (Ring)\n");
+	printf("------------------------------------------------------------------------\n");
+	printf("Addr: %p\t", ring_addr);
+	printf("Size: %d\t", ring_size);
+	printf("Head: %d\t", head);
+	printf("Tail: %d\t", tail);
+	printf("Used: %d\t", used);
+	printf("Mirrored: %s\t", mirrored ? "yes" : "no");
+	printf("\n");
+	printf("------------------------------------------------------------------------\n");
+	printf("Blocks\n");
+	printf("------------------------------------------------------------------------\n");
+	while (left > 0) {
+		span = ring_blk(off)->size + RING_ALIGN;
+		printf("Addr: %p\t", (void *)(ring_blk(off) + 1));
+		printf("Size: %d\t", ring_blk(off)->size);
+		printf("%s\t", ring_blk(off)->live ? "in use" : "released");
+		printf("\n");
+		if (span > left)
+			break;
+		left -= span;
+		off += span;
+		if (off >= cap)
+			off -= cap;
+	}
+	printf("------------------------------------------------------------------------\n");
+	printf("\n");
+}
+
+
+const pool_engine_t ring_engine = {
+	ring_init,
+	ring_alloc,
+	ring_release,
+	ring_get_size,
+	ring_check,
+	ring_log
+};
+
+
+// -----------------------------------------------------------------------------------------------
+// Maps a region twice in a row on the same memory, so a ring initialized on it with
+// POOL_MODE_RING places the blocks across its end without padding: the bytes past the end are
+// the ones of the start. Linux only, with memfd_create()
+//
+// Arguments:
+//  - size: the size of the region, a multiple of the page size
+// Returns:
+//  - the region's first byte, NULL if it can't be mapped or a region is already mapped
+// -----------------------------------------------------------------------------------------------
+void * pool_ring_mirror(pool_size_t size) {
+
+	#if defined(__linux__)
+	long page = sysconf(_SC_PAGESIZE);
+	char * addr;
+	int fd;
+
+	if (mirror_addr != NULL || size == 0 || page <= 0 || size % page != 0 || size > ~0u / 2)
+		return NULL;
+
+	fd = memfd_create("pool_ring", 0);
+	if (fd < 0)
+		return NULL;
+	if (ftruncate(fd, size) != 0) {
+		close(fd);
+		return NULL;
+	}
+
+	// Reserves the whole range, then maps the memory on each half
+	addr = mmap(NULL, 2 * size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (addr == MAP_FAILED) {
+		close(fd);
+		return NULL;
+	}
+	if (mmap(addr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) == MAP_FAILED ||
+		mmap(addr + size, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) == MAP_FAILED) {
+		munmap(addr, 2 * size);
+		close(fd);
+		return NULL;
+	}
+	close(fd);
+
+	mirror_addr = addr;
+	mirror_size = (unsigned int)size;
+
+	#ifdef POOL_ARENA_DEBUG
+	printf("  - mirrored region: %p, %d bytes\n", (void *)addr, mirror_size);
+	#endif
+
+	return addr;
+	#else
+	(void)size;
+	return NULL;
+	#endif
+}
+
+
+// -----------------------------------------------------------------------------------------------
+// Unmaps the region of pool_ring_mirror(). The ring initialized on it must no longer be used
+//
+// Arguments:
+//  - addr: the region's first byte
+// Returns:
+//  - 0 if the region has been unmapped, -1 otherwise
+// -----------------------------------------------------------------------------------------------
+int pool_ring_unmirror(void * addr) {
+
+	#if defined(__linux__)
+	if (addr == NULL || addr != mirror_addr)
+		return -1;
+
+	munmap(addr, 2 * (size_t)mirror_size);
+	if (mirrored && ring_addr == addr)
+		mirrored = 0;
+	mirror_addr = NULL;
+	mirror_size = 0;
+
+	return 0;
+	#else
+	(void)addr;
+	return -1;
+	#endif
+}
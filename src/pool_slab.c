@@ -0,0 +1,194 @@
+// distributed under the mit license
+// https://opensource.org/licenses/mit-license.php
+
+#include <stdio.h>
+#include <string.h>
+#include "pool_arena.h"
+
+// -----------------------------------------------------------------------------------------------
+// Local declarations
+// -----------------------------------------------------------------------------------------------
+
+// A slab is placed at the head of a block allocated in the arena, followed by its objects
+struct pool_slab {
+    // Size of an object, round up to a register
+    unsigned int obj_size;
+    // Number of objects the slab can store
+    unsigned int count;
+    // Number of objects currently allocated
+    unsigned int nb_used;
+    // Number of objects already handed out at least once. The objects above are
+    // never used, so the slab doesn't need to chain them at creation
+    unsigned int nb_carved;
+    // Released objects, chained by their first register
+    void * free;
+    // First object of the slab
+    char * objs;
+    // Bytes skipped at the head of the block to align the slab on a register
+    unsigned int offset;
+};
+
+// Size of a memory element, 32 or 64 bits
+static const unsigned int reg_size = sizeof(void *);
+
+
+// -----------------------------------------------------------------------------------------------
+// Creates a slab of count objects of obj_size bytes in the arena
+//
+// Arguments:
+//  - obj_size: size in bytes of an object
+//  - count: number of objects to reserve
+// Returns:
+//  - the slab, NULL if the arena can't store it
+// -----------------------------------------------------------------------------------------------
+pool_slab_t * pool_slab_create(unsigned int obj_size, unsigned int count) {
+
+	#ifdef POOL_ARENA_DEBUG
+	printf("------------------------------------------------------------------------\n");
+    printf("Pool Slab Create\n");
+	printf("------------------------------------------------------------------------\n");
+	#endif
+
+	pool_slab_t * slab;
+	char * blk;
+	unsigned int size;
+	unsigned int hdr;
+	unsigned int pad;
+
+	if (obj_size == 0 || count == 0) {
+		#ifdef POOL_ARENA_DEBUG
+        printf("ERROR: Can't create an empty slab\n");
+		#endif
+		return NULL;
+	}
+
+	// An object must be able to store the free list link once released
+	if (obj_size < reg_size)
+		obj_size = reg_size;
+	obj_size = (obj_size + reg_size - 1) & ~(reg_size - 1);
+	hdr = (sizeof(pool_slab_t) + reg_size - 1) & ~(reg_size - 1);
+
+	// Overflow, no arena can be that wide
+	if (obj_size > (~0u - hdr) / count) {
+		#ifdef POOL_ARENA_DEBUG
+        printf("ERROR: Slab size overflows\n");
+		#endif
+		return NULL;
+	}
+	size = hdr + obj_size * count;
+
+	// With the compact layout, the blocks are only aligned on 4 bytes, so the slab may have to
+	// skip the block's first bytes to start on a register
+	pad = POOL_ARENA_COMPACT ? reg_size - 4 : 0;
+	if (size > ~0u - pad)
+		return NULL;
+
+	blk = pool_malloc(size + pad);
+	if (blk == NULL)
+		return NULL;
+	slab = (pool_slab_t *)(blk + (reg_size - (size_t)blk % reg_size) % reg_size);
+	slab->offset = (unsigned int)((char *)slab - blk);
+
+	slab->obj_size = obj_size;
+	slab->count = count;
+	slab->nb_used = 0;
+	slab->nb_carved = 0;
+	slab->free = NULL;
+	slab->objs = (char *)slab + hdr;
+
+	#ifdef POOL_ARENA_DEBUG
+	printf("  - slab addr: %p\n", (void *)slab);
+	printf("  - object size: %d\n", obj_size);
+	printf("  - object count: %d\n", count);
+	printf("------------------------------------------------------------------------\n");
+	#endif
+
+	return slab;
+}
+
+
+// -----------------------------------------------------------------------------------------------
+// Allocates an object in a slab. Reuses first the last object released, else carves the next
+// object never used
+//
+// Arguments:
+//  - slab: the slab to allocate from
+// Returns:
+//  - the object's address, NULL if the slab is full
+// -----------------------------------------------------------------------------------------------
+void * pool_slab_alloc(pool_slab_t * slab) {
+
+	void * obj;
+
+	if (slab->free != NULL) {
+		obj = slab->free;
+		slab->free = *(void **)obj;
+	} else if (slab->nb_carved < slab->count) {
+		obj = slab->objs + slab->nb_carved * slab->obj_size;
+		slab->nb_carved += 1;
+	} else {
+		#ifdef POOL_ARENA_DEBUG
+		printf("ERROR: Slab %p is full\n", (void *)slab);
+		#endif
+		return NULL;
+	}
+
+	slab->nb_used += 1;
+
+	return obj;
+}
+
+
+// -----------------------------------------------------------------------------------------------
+// Releases an object of a slab
+//
+// Arguments:
+//  - slab: the slab owning the object
+//  - addr: the object's address
+// Returns:
+//  - 0 if the object belongs to the slab, -1 otherwise
+// -----------------------------------------------------------------------------------------------
+int pool_slab_free(pool_slab_t * slab, void * addr) {
+
+	char * obj = addr;
+
+	if (obj < slab->objs || obj >= slab->objs + slab->nb_carved * slab->obj_size ||
+		(obj - slab->objs) % slab->obj_size != 0) {
+		#ifdef POOL_ARENA_DEBUG
+		printf("ERROR: %p is not an object of slab %p\n", addr, (void *)slab);
+		#endif
+		return -1;
+	}
+
+	*(void **)obj = slab->free;
+	slab->free = obj;
+	slab->nb_used -= 1;
+
+	return 0;
+}
+
+
+// -----------------------------------------------------------------------------------------------
+// Releases a slab and all its objects in the arena
+//
+// Arguments:
+//  - slab: the slab to release
+// Returns:
+//  - 0 if succeeded, anything otherwise
+// -----------------------------------------------------------------------------------------------
+int pool_slab_destroy(pool_slab_t * slab) {
+	return pool_free((char *)slab - slab->offset);
+}
+
+
+// -----------------------------------------------------------------------------------------------
+// Returns the number of objects currently allocated in a slab
+//
+// Arguments:
+//  - slab: the slab to inspect
+// Returns:
+//  - the number of objects allocated
+// -----------------------------------------------------------------------------------------------
+unsigned int pool_slab_used(pool_slab_t * slab) {
+	return slab->nb_used;
+}
@@ -0,0 +1,546 @@
+// distributed under the mit license
+// https://opensource.org/licenses/mit-license.php
+
+#include <stdio.h>
+#include <string.h>
+#include "pool_arena.h"
+#include "pool_engine.h"
+
+// -----------------------------------------------------------------------------------------------
+// Local declarations
+// -----------------------------------------------------------------------------------------------
+
+// A TLSF block. As with the boundary tags layout of the list engine, the size register flags if
+// the block and its previous neighbor are in use, and a free block copies its size in its last
+// register (footer). prv/nxt chain the free blocks of the same class.
+struct tlsf_blk {
+    // Size of the data payload and the flags
+    unsigned int size;
+    // Pointer to the previous free block of the class
+    struct tlsf_blk * prv;
+    // Pointer to the next free block of the class
+    struct tlsf_blk * nxt;
+};
+
+typedef struct tlsf_blk tlsf_blk_t;
+
+#define TLSF_INUSE 0x1u
+#define TLSF_PINUSE 0x2u
+#define TLSF_FLAGS (TLSF_INUSE | TLSF_PINUSE)
+
+// Second level: each power of two is split in 16 linear classes
+#define SL_LOG2 4
+#define SL_COUNT (1 << SL_LOG2)
+// First level: the sizes smaller than SL_COUNT registers are gathered in the first class, one
+// register per second level class. The others are indexed by their power of two.
+#define FL_COUNT 32
+
+// Size of a memory element, 32 or 64 bits
+static const unsigned int reg_size = sizeof(void *);
+// Minimum payload: prv, nxt and the footer once released
+static const unsigned int min_payload = 3 * sizeof(void *);
+
+// Arena managed
+static void * tlsf_addr;
+static unsigned int tlsf_size;
+
+// Free blocks per class and the bitmaps flagging the non-empty ones
+static unsigned int fl_bitmap;
+static unsigned int sl_bitmap[FL_COUNT];
+static tlsf_blk_t * blocks[FL_COUNT][SL_COUNT];
+
+// Used to track arena status during usage and check if no leaks occur
+static int nb_alloc_blk;
+static int nb_free_blk;
+static unsigned int alloc_space;
+static unsigned int free_space;
+
+
+// Size of a block without the flags
+static inline unsigned int tlsf_blk_size(tlsf_blk_t * blk) {
+	return blk->size & ~TLSF_FLAGS;
+}
+
+
+// Copies the size of a free block in its last register
+static inline void tlsf_set_footer(tlsf_blk_t * blk) {
+	*(unsigned int *)((char *)blk + tlsf_blk_size(blk)) = tlsf_blk_size(blk);
+}
+
+
+// Returns the block physically following blk, NULL if blk is the last of the arena
+static inline tlsf_blk_t * tlsf_next(tlsf_blk_t * blk) {
+
+	char * nxt = (char *)blk + tlsf_blk_size(blk) + reg_size;
+
+	if (nxt >= (char *)tlsf_addr + tlsf_size)
+		return NULL;
+	return (tlsf_blk_t *)nxt;
+}
+
+
+// Returns the block physically preceding blk, only valid if this one is free
+static inline tlsf_blk_t * tlsf_prev(tlsf_blk_t * blk) {
+
+	unsigned int size = *(unsigned int *)((char *)blk - reg_size);
+
+	return (tlsf_blk_t *)((char *)blk - reg_size - size);
+}
+
+
+// -----------------------------------------------------------------------------------------------
+// Computes the first and second level indexes of a block size
+//
+// Arguments:
+//  - size: the block's payload size
+//  - fl: the first level index
+//  - sl: the second level index
+// Returns:
+//  - nothing
+// -----------------------------------------------------------------------------------------------
+static inline void mapping(unsigned int size, unsigned int * fl, unsigned int * sl) {
+
+	unsigned int fls;
+
+	if (size < SL_COUNT * reg_size) {
+		*fl = 0;
+		*sl = size / reg_size;
+	} else {
+		fls = find_last_set(size);
+		*fl = fls - find_last_set(SL_COUNT * reg_size) + 1;
+		*sl = (size >> (fls - SL_LOG2)) - SL_COUNT;
+	}
+}
+
+
+// -----------------------------------------------------------------------------------------------
+// Same than mapping(), but round up the size to the next class, so any block of this class is
+// wide enough to store size bytes
+//
+// Arguments:
+//  - size: the payload size requested
+//  - fl: the first level index
+//  - sl: the second level index
+// Returns:
+//  - -1 if size can't be round up, 0 otherwise
+// -----------------------------------------------------------------------------------------------
+static inline int mapping_search(unsigned int size, unsigned int * fl, unsigned int * sl) {
+
+	unsigned int round;
+
+	if (size >= SL_COUNT * reg_size) {
+		round = (1u << (find_last_set(size) - SL_LOG2)) - 1;
+		if (size > ~0u - round)
+			return -1;
+		size += round;
+	}
+	mapping(size, fl, sl);
+
+	return 0;
+}
+
+
+// -----------------------------------------------------------------------------------------------
+// Finds the first non-empty class at or above fl/sl with the bitmaps
+//
+// Arguments:
+//  - fl: the first level index, updated with the class found
+//  - sl: the second level index, updated with the class found
+// Returns:
+//  - the head of the class, NULL if no class is available
+// -----------------------------------------------------------------------------------------------
+static inline tlsf_blk_t * find_suitable(unsigned int * fl, unsigned int * sl) {
+
+	unsigned int sl_map = sl_bitmap[*fl] & (~0u << *sl);
+	unsigned int fl_map;
+
+	if (sl_map == 0) {
+		// No block in this power of two, move to a wider one
+		if (*fl + 1 >= FL_COUNT)
+			return NULL;
+		fl_map = fl_bitmap & (~0u << (*fl + 1));
+		if (fl_map == 0)
+			return NULL;
+		*fl = find_first_set(fl_map);
+		sl_map = sl_bitmap[*fl];
+	}
+	*sl = find_first_set(sl_map);
+
+	return blocks[*fl][*sl];
+}
+
+
+// Chain a free block on top of its class
+static inline void tlsf_insert(tlsf_blk_t * blk) {
+
+	unsigned int fl;
+	unsigned int sl;
+
+	mapping(tlsf_blk_size(blk), &fl, &sl);
+	blk->prv = NULL;
+	blk->nxt = blocks[fl][sl];
+	if (blk->nxt != NULL)
+		blk->nxt->prv = blk;
+	blocks[fl][sl] = blk;
+	fl_bitmap |= 1u << fl;
+	sl_bitmap[fl] |= 1u << sl;
+}
+
+
+// Unchain a free block from its class
+static inline void tlsf_remove(tlsf_blk_t * blk) {
+
+	unsigned int fl;
+	unsigned int sl;
+
+	mapping(tlsf_blk_size(blk), &fl, &sl);
+	if (blk->prv != NULL)
+		blk->prv->nxt = blk->nxt;
+	else
+		blocks[fl][sl] = blk->nxt;
+	if (blk->nxt != NULL)
+		blk->nxt->prv = blk->prv;
+
+	if (blocks[fl][sl] == NULL) {
+		sl_bitmap[fl] &= ~(1u << sl);
+		if (sl_bitmap[fl] == 0)
+			fl_bitmap &= ~(1u << fl);
+	}
+}
+
+
+// -----------------------------------------------------------------------------------------------
+// Setups the arena as a single free block
+//
+// Arguments:
+//  - addr: address of the arena's first byte
+//  - size: size in byte available for the arena
+// Returns:
+//  - -1 if size is too small to contain at least 1 byte, otherwise 0
+// -----------------------------------------------------------------------------------------------
+static int tlsf_init(void * addr, unsigned int size) {
+
+	tlsf_blk_t * blk = addr;
+
+	size &= ~(reg_size - 1);
+	if (size < reg_size + min_payload)
+		return -1;
+
+	tlsf_addr = addr;
+	tlsf_size = size;
+	fl_bitmap = 0;
+	memset(sl_bitmap, 0, sizeof(sl_bitmap));
+	memset(blocks, 0, sizeof(blocks));
+
+	nb_alloc_blk = 0;
+	alloc_space = 0;
+	nb_free_blk = 1;
+	free_space = size - reg_size;
+
+	blk->size = free_space | TLSF_PINUSE;
+	tlsf_set_footer(blk);
+	tlsf_insert(blk);
+
+    #ifdef POOL_ARENA_DEBUG
+    printf("TLSF Setup:\n");
+    printf("  - register size: %d bytes\n", reg_size);
+    printf("  - classes: %d x %d\n", FL_COUNT, SL_COUNT);
+    printf("  - pool size: %d bytes\n", size);
+	printf("------------------------------------------------------------------------\n");
+    #endif
+
+	return 0;
+}
+
+
+// -----------------------------------------------------------------------------------------------
+// Allocates a block: a class wide enough is found with two bitmap lookups, its head is
+// unchained and forked if the remaining space can store a free block. No loop depends on the
+// arena's content, the worst-case cycles are measured by `make bench`
+//
+// Argument:
+//  - size: the number of bytes the block needs to own
+// Returns:
+//  - the address of the buffer's first byte, NULL if failed
+// -----------------------------------------------------------------------------------------------
+static void * tlsf_alloc(unsigned int size) {
+
+	tlsf_blk_t * blk;
+	tlsf_blk_t * rem;
+	tlsf_blk_t * nxt;
+	unsigned int fl;
+	unsigned int sl;
+	unsigned int blk_size;
+
+	if (size == 0) {
+		#ifdef POOL_ARENA_DEBUG
+        printf("ERROR: Can't allocate a zero-byte block\n");
+		#endif
+		return NULL;
+	}
+
+	if (size > ~0u - reg_size)
+		return NULL;
+	size = (size + reg_size - 1) & ~(reg_size - 1);
+	if (size < min_payload)
+		size = min_payload;
+
+	blk = NULL;
+	if (mapping_search(size, &fl, &sl) == 0)
+		blk = find_suitable(&fl, &sl);
+
+	// No wider class, but the head of the size's own class may be wide enough
+	if (blk == NULL) {
+		mapping(size, &fl, &sl);
+		if (blocks[fl][sl] != NULL && tlsf_blk_size(blocks[fl][sl]) >= size)
+			blk = blocks[fl][sl];
+	}
+
+	if (blk == NULL) {
+		#ifdef POOL_ARENA_DEBUG
+		printf("ERROR: Can't find a enough space to store a new block\n");
+		printf("  - requested free space: %d\n", size);
+		printf("  - current free space: %d\n", free_space);
+		#endif
+		return NULL;
+	}
+
+	tlsf_remove(blk);
+	blk_size = tlsf_blk_size(blk);
+
+	if (blk_size - size >= reg_size + min_payload) {
+		// Fork the block, the remaining space is released in its class
+		rem = (tlsf_blk_t *)((char *)blk + reg_size + size);
+		rem->size = (blk_size - size - reg_size) | TLSF_PINUSE;
+		tlsf_set_footer(rem);
+		tlsf_insert(rem);
+		blk->size = size | TLSF_INUSE | (blk->size & TLSF_PINUSE);
+		free_space -= size + reg_size;
+	} else {
+		// Too narrow to be forked, the whole block is used
+		size = blk_size;
+		blk->size |= TLSF_INUSE;
+		nxt = tlsf_next(blk);
+		if (nxt != NULL)
+			nxt->size |= TLSF_PINUSE;
+		nb_free_blk -= 1;
+		free_space -= size;
+	}
+
+	nb_alloc_blk += 1;
+	alloc_space += size;
+
+	#ifdef POOL_ARENA_DEBUG
+	printf("  - allocated addr: %p\n", (void *)blk);
+	printf("  - size: %d\n", size);
+	printf("  - class: %d/%d\n", fl, sl);
+	printf("------------------------------------------------------------------------\n");
+	#endif
+
+	return (char *)blk + reg_size;
+}
+
+
+// -----------------------------------------------------------------------------------------------
+// Releases a block: merges it with its free physical neighbors found with the boundary tags then
+// chains it in its class. No loop depends on the arena's content, the worst-case cycles are
+// measured by `make bench`
+//
+// Arguments:
+//  - addr: the address of the data block
+// Returns:
+//  - 0 if block has been released, -1 if the address is not in the arena
+// -----------------------------------------------------------------------------------------------
+static int tlsf_release(void * addr) {
+
+	tlsf_blk_t * blk = (tlsf_blk_t *)((char *)addr - reg_size);
+	tlsf_blk_t * nxt;
+	tlsf_blk_t * prv;
+
+	if ((void *)blk < tlsf_addr || (char *)blk >= (char *)tlsf_addr + tlsf_size ||
+		!(blk->size & TLSF_INUSE)) {
+		#ifdef POOL_ARENA_DEBUG
+		printf("ERROR: %p is not an allocated block\n", addr);
+		#endif
+		return -1;
+	}
+
+	#ifdef POOL_ARENA_DEBUG
+	printf("  - addr to free: %p\n", addr);
+	printf("  - size to free: %d\n", tlsf_blk_size(blk));
+	#endif
+
+	nb_alloc_blk -= 1;
+	alloc_space -= tlsf_blk_size(blk);
+	nb_free_blk += 1;
+	free_space += tlsf_blk_size(blk);
+
+	// Merge with the previous block if free
+	if (!(blk->size & TLSF_PINUSE)) {
+		prv = tlsf_prev(blk);
+		tlsf_remove(prv);
+		prv->size += tlsf_blk_size(blk) + reg_size;
+		blk = prv;
+		nb_free_blk -= 1;
+		free_space += reg_size;
+	}
+
+	// Merge with the next block if free
+	nxt = tlsf_next(blk);
+	if (nxt != NULL && !(nxt->size & TLSF_INUSE)) {
+		tlsf_remove(nxt);
+		blk->size += tlsf_blk_size(nxt) + reg_size;
+		nb_free_blk -= 1;
+		free_space += reg_size;
+	}
+
+	blk->size &= ~TLSF_INUSE;
+	tlsf_set_footer(blk);
+	nxt = tlsf_next(blk);
+	if (nxt != NULL)
+		nxt->size &= ~TLSF_PINUSE;
+	tlsf_insert(blk);
+
+	#ifdef POOL_ARENA_DEBUG
+	printf("------------------------------------------------------------------------\n");
+	#endif
+
+	return 0;
+}
+
+
+// Return the size of chunk located @ address
+static unsigned int tlsf_get_size(void * addr) {
+	return tlsf_blk_size((tlsf_blk_t *)((char *)addr - reg_size));
+}
+
+
+// -----------------------------------------------------------------------------------------------
+// Checks the statistics, the boundary tags and the classes are coherent
+//
+// Arguments:
+//	- None
+// Returns:
+// 	- 1 if space range is not equal to initial setup, 0 otherwise
+// -----------------------------------------------------------------------------------------------
+static int tlsf_check(void) {
+
+	unsigned int alloc = nb_alloc_blk * reg_size + alloc_space;
+	unsigned int free = nb_free_blk * reg_size + free_space;
+	char * parse = tlsf_addr;
+	tlsf_blk_t * blk;
+	int prv_free = 0;
+	int phy_cnt = 0;
+	int cls_cnt = 0;
+	int err = 0;
+	unsigned int fl;
+	unsigned int sl;
+
+	// Parse the arena block by block
+	while (parse < (char *)tlsf_addr + tlsf_size) {
+		blk = (tlsf_blk_t *)parse;
+		if (((blk->size & TLSF_PINUSE) != 0) == prv_free)
+			err = 1;
+		prv_free = !(blk->size & TLSF_INUSE);
+		if (prv_free) {
+			if (*(unsigned int *)(parse + tlsf_blk_size(blk)) != tlsf_blk_size(blk))
+				err = 1;
+			phy_cnt += 1;
+		}
+		parse += tlsf_blk_size(blk) + reg_size;
+	}
+	if (parse != (char *)tlsf_addr + tlsf_size)
+		err = 1;
+
+	// Parse the classes
+	for (unsigned int i = 0; i < FL_COUNT; i++) {
+		if ((sl_bitmap[i] != 0) != ((fl_bitmap >> i) & 1))
+			err = 1;
+		for (unsigned int j = 0; j < SL_COUNT; j++) {
+			if ((blocks[i][j] != NULL) != ((sl_bitmap[i] >> j) & 1))
+				err = 1;
+			for (blk = blocks[i][j]; blk != NULL; blk = blk->nxt) {
+				mapping(tlsf_blk_size(blk), &fl, &sl);
+				if (fl != i || sl != j || (blk->size & TLSF_INUSE))
+					err = 1;
+				cls_cnt += 1;
+			}
+		}
+	}
+
+	#ifdef POOL_ARENA_DEBUG
+	printf("\n");
+	printf("------------------------------------------------------------------------\n");
+	printf("Pool Check (TLSF)\n");
+	printf("------------------------------------------------------------------------\n");
+	printf("Arena space: %d\n", tlsf_size);
+	printf("  - nb alloc space: %d\n", nb_alloc_blk);
+	printf("  - alloc space: %d\n", alloc_space);
+	printf("  - nb free space: %d\n", nb_free_blk);
+	printf("  - counted nb free space: %d / %d\n", phy_cnt, cls_cnt);
+	printf("  - free space: %d\n", free_space);
+	printf("Arena vs Computed: %d\n", tlsf_size - alloc - free);
+	printf("------------------------------------------------------------------------\n");
+	#endif
+
+	if (tlsf_size != alloc + free || phy_cnt != nb_free_blk || cls_cnt != nb_free_blk || err) {
+		#ifdef POOL_ARENA_DEBUG
+		printf("ERROR: Free space doesn't match\n");
+		printf("------------------------------------------------------------------------\n");
+		#endif
+		return 1;
+	}
+
+	return 0;
+}
+
+
+// Print the blocks of the arena and the classes
+static void tlsf_log(void) {
+
+	char * parse = tlsf_addr;
+	tlsf_blk_t * blk;
+
+	printf("\n");
+	printf("------------------------------------------------------------------------\n");
+	printf("Pool Arena (TLSF)\n");
+	printf("------------------------------------------------------------------------\n");
+	printf("Addr: %p\t", tlsf_addr);
+	printf("Size: %d\t", tlsf_size);
+	printf("\n");
+	printf("------------------------------------------------------------------------\n");
+	printf("Blocks\n");
+	printf("------------------------------------------------------------------------\n");
+	while (parse < (char *)tlsf_addr + tlsf_size) {
+		blk = (tlsf_blk_t *)parse;
+		printf("Addr: %p\t", (void *)blk);
+		printf("Size: %d\t", tlsf_blk_size(blk));
+		printf("%s\n", (blk->size & TLSF_INUSE) ? "Used" : "Free");
+		parse += tlsf_blk_size(blk) + reg_size;
+	}
+	printf("------------------------------------------------------------------------\n");
+	printf("Classes\n");
+	printf("------------------------------------------------------------------------\n");
+	for (unsigned int i = 0; i < FL_COUNT; i++) {
+		for (unsigned int j = 0; j < SL_COUNT; j++) {
+			if (blocks[i][j] == NULL)
+				continue;
+			printf("Class: %d/%d\t", i, j);
+			for (blk = blocks[i][j]; blk != NULL; blk = blk->nxt)
+				printf("%p (%d) ", (void *)blk, tlsf_blk_size(blk));
+			printf("\n");
+		}
+	}
+	printf("------------------------------------------------------------------------\n");
+	printf("\n");
+}
+
+
+const pool_engine_t tlsf_engine = {
+	tlsf_init,
+	tlsf_alloc,
+	tlsf_release,
+	tlsf_get_size,
+	tlsf_check,
+	tlsf_log
+};
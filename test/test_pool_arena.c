@@ -8,11 +8,28 @@
 
 #include "pool_arena.h"
 
+#if defined(__linux__)
+#include <stdint.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
 #define NB_PT 16
 #define ARENA_SIZE 16384
 
 
+// Size register of the list engine's modes
+#if POOL_ARENA_COMPACT
+unsigned int reg_size = 4;
+#else
 unsigned int reg_size = sizeof(void *);
+#endif
+// Size register's bit flagging a long-lived block
+#if POOL_ARENA_BTAG
+#define HINT_LONG_BIT ((pool_size_t)1 << (8 * sizeof(pool_size_t) - 1))
+#else
+#define HINT_LONG_BIT ((pool_size_t)0x2)
+#endif
 void * arena;
 
 void * blks_pt[NB_PT];
@@ -119,7 +136,7 @@ void print_blks(void) {
 			end = (char *)blks_pt[i] + pool_get_size(blks_pt[i]) - 1;
 			printf("Addr: %p\t", blks_pt[i]);
 			printf("End: %p\t", end);
-			printf("Size: %d\t", pool_get_size(blks_pt[i]));
+			printf("Size: %lu\t", (unsigned long)pool_get_size(blks_pt[i]));
 			printf("\n");
 		}
 	}
@@ -275,6 +292,242 @@ void test_realloc_ko(void) {
 }
 
 
+// A block grows in place over its free next neighbor and shrinks in place,
+// else moves with only its own bytes copied
+void test_realloc_in_place(void) {
+
+	int modes[4] = {POOL_MODE_LIST, POOL_MODE_SEGREGATED, POOL_MODE_TREE, POOL_MODE_SOA};
+	char * pt;
+
+	for (int m=0; m<4; m++) {
+		TEST_ASSERT_EQUAL_INT(0, pool_init_mode(arena, ARENA_SIZE, modes[m]));
+		TEST_ASSERT_NULL(pool_realloc(NULL, 0));
+		for (int i=0; i<3; i++)
+			alloc_blk(i, 4*reg_size);
+		fill_blks(4*reg_size);
+
+		// The hole left by the block 1 is absorbed
+		free_blk(1);
+		pt = pool_realloc(blks_pt[0], 6*reg_size);
+		TEST_ASSERT_TRUE(pt == blks_pt[0]);
+		TEST_ASSERT_TRUE(pool_get_size(pt) >= 6*reg_size);
+		check_blks(4*reg_size);
+		TEST_ASSERT_EQUAL_INT(0, pool_check());
+
+		// The block 2 is in use, the block moves
+		pt = pool_realloc(blks_pt[0], 20*reg_size);
+		TEST_ASSERT_NOT_NULL(pt);
+		TEST_ASSERT_TRUE(pt != blks_pt[0]);
+		blks_pt[0] = pt;
+		check_blks(4*reg_size);
+		TEST_ASSERT_EQUAL_INT(0, pool_check());
+
+		// Shrunk, its tail is released then taken back in place
+		pt = pool_realloc(blks_pt[0], 2*reg_size);
+		TEST_ASSERT_TRUE(pt == blks_pt[0]);
+		TEST_ASSERT_TRUE(pool_get_size(pt) < 20*reg_size);
+		TEST_ASSERT_EQUAL_INT(0, pool_check());
+		pt = pool_realloc(blks_pt[0], 16*reg_size);
+		TEST_ASSERT_TRUE(pt == blks_pt[0]);
+		check_blks(2*reg_size);
+		TEST_ASSERT_EQUAL_INT(0, pool_check());
+
+		// The last block grows over the free space
+		pt = pool_realloc(blks_pt[0], ARENA_SIZE/2);
+		TEST_ASSERT_TRUE(pt == blks_pt[0]);
+		check_blks(2*reg_size);
+		TEST_ASSERT_EQUAL_INT(0, pool_check());
+		free_blks();
+		TEST_ASSERT_EQUAL_INT(0, pool_check());
+	}
+
+	// The hint stays accounted with the payload resized
+	TEST_ASSERT_EQUAL_INT(0, pool_init(arena, ARENA_SIZE));
+	pt = pool_malloc_hint(8*reg_size, POOL_HINT_SHORT);
+	TEST_ASSERT_TRUE(pool_realloc(pt, 2*reg_size) == pt);
+	TEST_ASSERT_EQUAL_INT(0, pool_check());
+	TEST_ASSERT_TRUE(pool_realloc(pt, 12*reg_size) == pt);
+	TEST_ASSERT_EQUAL_INT(0, pool_check());
+	TEST_ASSERT_EQUAL_INT(0, pool_free(pt));
+	TEST_ASSERT_EQUAL_INT(0, check_pool_free_space());
+
+	// The other engines only shrink in place
+	TEST_ASSERT_EQUAL_INT(0, pool_init_mode(arena, ARENA_SIZE, POOL_MODE_TLSF));
+	alloc_blk(0, 64);
+	fill_blk(0, 64);
+	TEST_ASSERT_TRUE(pool_realloc(blks_pt[0], 32) == blks_pt[0]);
+	blks_pt[0] = pool_realloc(blks_pt[0], 4096);
+	TEST_ASSERT_NOT_NULL(blks_pt[0]);
+	check_blks(64);
+	free_blks();
+	TEST_ASSERT_EQUAL_INT(0, pool_check());
+}
+
+
+// The aligned blocks are regular blocks, the leading slack being reused
+void test_aligned_alloc(void) {
+
+	int modes[5] = {POOL_MODE_LIST, POOL_MODE_SEGREGATED, POOL_MODE_TREE,
+					POOL_MODE_SOA, POOL_MODE_LIST | POOL_OPT_QUICK};
+	unsigned int aligns[4] = {16, 32, 64, 256};
+	char * pt;
+
+	TEST_ASSERT_EQUAL_INT(0, pool_init_mode(arena, ARENA_SIZE, modes[0]));
+	TEST_ASSERT_NULL(pool_aligned_alloc(0, 16));
+	TEST_ASSERT_NULL(pool_aligned_alloc(24, 16));
+	TEST_ASSERT_NULL(pool_aligned_alloc(64, 0));
+	TEST_ASSERT_NULL(pool_aligned_alloc(64, ARENA_SIZE));
+
+	// The slack before the first aligned block is free again
+	pt = pool_aligned_alloc(64, 100);
+	TEST_ASSERT_EQUAL_INT(0, (size_t)pt % 64);
+	while ((blks_pt[0] = pool_malloc(1)) != NULL && blks_pt[0] > (void *)pt);
+	TEST_ASSERT_NOT_NULL(blks_pt[0]);
+	TEST_ASSERT_EQUAL_INT(0, pool_check());
+
+	for (int m=0; m<5; m++) {
+		TEST_ASSERT_EQUAL_INT(0, pool_init_mode(arena, ARENA_SIZE, modes[m]));
+		for (int i=0; i<NB_PT; i++) {
+			blks_pt[i] = pool_aligned_alloc(aligns[i%4], 1 + i*13);
+			TEST_ASSERT_NOT_NULL(blks_pt[i]);
+			TEST_ASSERT_EQUAL_INT(0, (size_t)blks_pt[i] % aligns[i%4]);
+			TEST_ASSERT_TRUE(pool_get_size(blks_pt[i]) >= 1 + i*13u);
+			blks_sts[i] = 1;
+		}
+		fill_blks(1);
+		TEST_ASSERT_EQUAL_INT(0, pool_check());
+		free_blk(3);
+		free_blk(8);
+		blks_pt[5] = pool_realloc(blks_pt[5], 300);
+		TEST_ASSERT_NOT_NULL(blks_pt[5]);
+		check_blks(1);
+		TEST_ASSERT_EQUAL_INT(0, pool_check());
+		free_blks();
+		pool_consolidate();
+		TEST_ASSERT_EQUAL_INT(0, pool_check());
+		TEST_ASSERT_EQUAL_INT(0, pool_free(pool_malloc(ARENA_SIZE/2)));
+	}
+
+	// The padding is bumped with the block in a scope
+	TEST_ASSERT_EQUAL_INT(0, pool_scope_begin(1024));
+	pt = pool_aligned_alloc(64, 10);
+	TEST_ASSERT_EQUAL_INT(0, (size_t)pt % 64);
+	TEST_ASSERT_TRUE(pool_aligned_alloc(64, 10) == pt + 64);
+	TEST_ASSERT_EQUAL_INT(0, pool_scope_end());
+
+	// The buddy engine's blocks are aligned on their size
+	TEST_ASSERT_EQUAL_INT(0, pool_init_mode(arena, ARENA_SIZE, POOL_MODE_BUDDY));
+	pt = pool_aligned_alloc(64, 10);
+	TEST_ASSERT_NOT_NULL(pt);
+	TEST_ASSERT_EQUAL_INT(0, (size_t)pt % 64);
+	TEST_ASSERT_EQUAL_INT(0, pool_free(pt));
+	TEST_ASSERT_EQUAL_INT(0, pool_check());
+}
+
+
+// A batch is carved from a few free blocks, and released in any order with
+// its blocks merged back
+void test_batch(void) {
+
+	int modes[6] = {POOL_MODE_LIST, POOL_MODE_SEGREGATED, POOL_MODE_TREE, POOL_MODE_SOA,
+					POOL_MODE_LIST | POOL_OPT_QUICK, POOL_MODE_TLSF};
+	void * pts[128];
+	void * holes[8];
+	unsigned int nb;
+
+	for (int m=0; m<6; m++) {
+		TEST_ASSERT_EQUAL_INT(0, pool_init_mode(arena, ARENA_SIZE, modes[m]));
+		TEST_ASSERT_EQUAL_INT(0, pool_malloc_batch(16, 4, NULL));
+
+		// A fresh arena gives contiguous blocks
+		TEST_ASSERT_EQUAL_INT(64, pool_malloc_batch(6*reg_size, 64, pts));
+		for (int i=0; i<64; i++) {
+			TEST_ASSERT_TRUE(pool_get_size(pts[i]) >= 6*reg_size);
+			memset(pts[i], i, 6*reg_size);
+			if (i && modes[m] != POOL_MODE_TLSF)
+				TEST_ASSERT_TRUE((char *)pts[i] == (char *)pts[i-1] + 7*reg_size);
+		}
+		TEST_ASSERT_EQUAL_INT(0, pool_check());
+
+		// Holes too narrow for the whole batch, then released in reverse order
+		for (int i=0; i<8; i++)
+			holes[i] = pts[i*8];
+		TEST_ASSERT_EQUAL_INT(0, pool_free_batch(holes, 8));
+		TEST_ASSERT_EQUAL_INT(0, pool_check());
+		TEST_ASSERT_EQUAL_INT(64, pool_malloc_batch(2*reg_size, 64, pts + 64));
+		TEST_ASSERT_EQUAL_INT(0, pool_check());
+		for (int i=1; i<64; i++) {
+			if (i % 8)
+				TEST_ASSERT_EQUAL_INT(i, ((unsigned char *)pts[i])[6*reg_size - 1]);
+		}
+		for (int i=0; i<8; i++)
+			pts[i*8] = NULL;
+		for (int i=0; i<64; i++) {
+			holes[0] = pts[i];
+			pts[i] = pts[127 - i];
+			pts[127 - i] = holes[0];
+		}
+		TEST_ASSERT_EQUAL_INT(0, pool_free_batch(pts, 128));
+		pool_consolidate();
+		TEST_ASSERT_EQUAL_INT(0, pool_check());
+		TEST_ASSERT_EQUAL_INT(0, pool_free(pool_malloc(ARENA_SIZE/2)));
+		if (modes[m] == POOL_MODE_LIST)
+			TEST_ASSERT_EQUAL_INT(0, check_pool_free_space());
+
+		// The arena exhausted, a part of the batch is allocated
+		nb = pool_malloc_batch(ARENA_SIZE/5, 8, pts);
+		TEST_ASSERT_TRUE(nb > 0 && nb < 8);
+		TEST_ASSERT_EQUAL_INT(0, pool_check());
+		TEST_ASSERT_EQUAL_INT(0, pool_free_batch(pts, nb));
+		TEST_ASSERT_EQUAL_INT(0, pool_check());
+	}
+}
+
+
+// The objects of a record are contiguous, and released one by one
+void test_comalloc(void) {
+
+	int modes[5] = {POOL_MODE_LIST, POOL_MODE_SEGREGATED, POOL_MODE_TREE, POOL_MODE_SOA,
+					POOL_MODE_TLSF};
+	pool_size_t sizes[4] = {24, 100, 1, 40};
+	pool_size_t wide[2] = {100, ARENA_SIZE};
+
+	for (int m=0; m<5; m++) {
+		TEST_ASSERT_EQUAL_INT(0, pool_init_mode(arena, ARENA_SIZE, modes[m]));
+		TEST_ASSERT_EQUAL_INT(-1, pool_comalloc(0, sizes, blks_pt));
+		TEST_ASSERT_EQUAL_INT(-1, pool_comalloc(POOL_ARENA_COMALLOC + 1, sizes, blks_pt));
+		TEST_ASSERT_EQUAL_INT(-1, pool_comalloc(2, wide, blks_pt));
+		TEST_ASSERT_EQUAL_INT(0, pool_check());
+
+		for (int r=0; r<2; r++) {
+			TEST_ASSERT_EQUAL_INT(0, pool_comalloc(4, sizes, blks_pt + 4*r));
+			for (int i=4*r; i<4*r+4; i++) {
+				blks_sts[i] = 1;
+				TEST_ASSERT_TRUE(pool_get_size(blks_pt[i]) >= sizes[i%4]);
+				if (i%4 && modes[m] != POOL_MODE_TLSF)
+					TEST_ASSERT_TRUE((char *)blks_pt[i] ==
+									 (char *)blks_pt[i-1] + pool_get_size(blks_pt[i-1]) + reg_size);
+			}
+		}
+		fill_blks(1);
+		TEST_ASSERT_EQUAL_INT(0, pool_check());
+		free_blk(1);
+		free_blk(6);
+		check_blks(1);
+		TEST_ASSERT_EQUAL_INT(0, pool_check());
+		free_blks();
+		TEST_ASSERT_EQUAL_INT(0, pool_check());
+		TEST_ASSERT_EQUAL_INT(0, pool_free(pool_malloc(ARENA_SIZE/2)));
+	}
+
+	// A scope allocates the objects one by one in its region
+	TEST_ASSERT_EQUAL_INT(0, pool_scope_begin(1024));
+	TEST_ASSERT_EQUAL_INT(0, pool_comalloc(4, sizes, blks_pt));
+	TEST_ASSERT_EQUAL_INT(-1, pool_comalloc(2, wide, blks_pt));
+	TEST_ASSERT_EQUAL_INT(0, pool_scope_end());
+	TEST_ASSERT_EQUAL_INT(0, pool_check());
+}
+
 
 // Allocate blocks in the pool arena, fill them and checks the data
 // integrity while freeing some blocks
@@ -417,6 +670,1223 @@ void test_free_space_recovering(void) {
 
 
 
+// Releases blocks in all orders to check the merging with the neighbors
+void test_merge_orders(void) {
+
+	int orders[4][5] = {{0,1,2,3,4}, {4,3,2,1,0}, {1,3,0,4,2}, {2,0,4,1,3}};
+
+	for (int o=0; o<4; o++) {
+		TEST_ASSERT_EQUAL_INT(0, pool_init(arena, ARENA_SIZE));
+		for (int i=0; i<5; i++)
+			alloc_blk(i, (i+1)*3*reg_size);
+		fill_blks(3*reg_size);
+		for (int i=0; i<5; i++) {
+			free_blk(orders[o][i]);
+			check_blks(3*reg_size);
+			TEST_ASSERT_EQUAL_INT(0, pool_check());
+		}
+		TEST_ASSERT_EQUAL_INT(0, check_pool_free_space());
+	}
+}
+
+
+// Same stress than test_free_space_recovering() but with the size classes
+void test_segregated(void) {
+
+	unsigned int chunk_size;
+	chunk_size = 1;
+
+    TEST_ASSERT_EQUAL_INT(0, pool_init_mode(arena, ARENA_SIZE, POOL_MODE_SEGREGATED));
+
+	while (chunk_size < ARENA_SIZE) {
+
+		alloc_blks(chunk_size);
+		fill_blks(chunk_size);
+		check_blks(chunk_size);
+		TEST_ASSERT_EQUAL_INT(0, pool_check());
+		free_blk(1);
+		free_blk(5);
+		free_blk(2);
+		TEST_ASSERT_EQUAL_INT(0, pool_check());
+		alloc_blks(chunk_size/2+1);
+		TEST_ASSERT_EQUAL_INT(0, pool_check());
+		free_blks();
+		TEST_ASSERT_EQUAL_INT(0, pool_check());
+		TEST_ASSERT_EQUAL_INT(0, check_pool_free_space());
+		chunk_size += 7;
+	}
+}
+
+
+// A freed block must be reused by a request of its size class
+void test_segregated_reuse(void) {
+
+    TEST_ASSERT_EQUAL_INT(0, pool_init_mode(arena, ARENA_SIZE, POOL_MODE_SEGREGATED));
+
+	alloc_blks(256);
+	TEST_ASSERT_EQUAL_INT(0, pool_check());
+	void * hole = blks_pt[3];
+	free_blk(3);
+	free_blk(8);
+	TEST_ASSERT_EQUAL_INT(0, pool_check());
+	// the holes left by the blocks 3 and 8 are in a smaller class than
+	// the free space at the end of the arena, so one of them is picked up
+	blks_pt[3] = pool_malloc(128);
+	TEST_ASSERT_TRUE(blks_pt[3] == hole || blks_pt[3] == blks_pt[8]);
+	blks_sts[3] = 1;
+	pool_log();
+	TEST_ASSERT_EQUAL_INT(0, pool_check());
+	free_blks();
+	TEST_ASSERT_EQUAL_INT(0, pool_check());
+	TEST_ASSERT_EQUAL_INT(0, check_pool_free_space());
+}
+
+
+// Creates three holes of 20, 14 and 40 registers separated by allocated
+// blocks, then returns where a 2 registers block is placed
+void * place_in_holes(int mode) {
+
+    TEST_ASSERT_EQUAL_INT(0, pool_init_mode(arena, ARENA_SIZE, mode));
+	for (int i=0; i<NB_PT; i++)
+		blks_sts[i] = 0;
+	alloc_blk(0, 20*reg_size);
+	alloc_blk(1, reg_size);
+	alloc_blk(2, 14*reg_size);
+	alloc_blk(3, reg_size);
+	alloc_blk(4, 40*reg_size);
+	alloc_blk(5, reg_size);
+	free_blk(0);
+	free_blk(2);
+	free_blk(4);
+    TEST_ASSERT_EQUAL_INT(0, pool_check());
+	return pool_malloc(2*reg_size);
+}
+
+
+// Check each placement policy selects the expected hole
+void test_policies(void) {
+
+	void * pt;
+
+	pt = place_in_holes(POOL_MODE_LIST | POOL_FIT_NEXT);
+	TEST_ASSERT_TRUE(pt == blks_pt[4]);
+	TEST_ASSERT_EQUAL_INT(0, pool_check());
+
+	pt = place_in_holes(POOL_MODE_LIST | POOL_FIT_FIRST);
+	TEST_ASSERT_TRUE(pt == blks_pt[0]);
+	TEST_ASSERT_EQUAL_INT(0, pool_check());
+
+	pt = place_in_holes(POOL_MODE_LIST | POOL_FIT_BEST);
+	TEST_ASSERT_TRUE(pt == blks_pt[2]);
+	TEST_ASSERT_EQUAL_INT(0, pool_check());
+
+	pt = place_in_holes(POOL_MODE_LIST | POOL_FIT_WORST);
+	TEST_ASSERT_TRUE(pt > blks_pt[5]);
+	TEST_ASSERT_EQUAL_INT(0, pool_check());
+	TEST_ASSERT_EQUAL_INT(0, pool_free(pt));
+	free_blks();
+	TEST_ASSERT_EQUAL_INT(0, pool_check());
+	TEST_ASSERT_EQUAL_INT(0, check_pool_free_space());
+}
+
+
+// The first-fit selects the lowest address whatever the order the blocks
+// have been released in, the boundary tags chaining them out of order
+void test_first_fit_order(void) {
+
+    TEST_ASSERT_EQUAL_INT(0, pool_init_mode(arena, ARENA_SIZE, POOL_MODE_LIST | POOL_FIT_FIRST));
+	for (int i=0; i<8; i++)
+		alloc_blk(i, 256);
+	free_blk(1);
+	free_blk(5);
+	free_blk(3);
+	TEST_ASSERT_EQUAL_INT(0, pool_check());
+	alloc_blk(1, 200);
+	TEST_ASSERT_TRUE(pool_get_size(blks_pt[1]) >= 200);
+	TEST_ASSERT_TRUE(blks_pt[1] < blks_pt[2]);
+	alloc_blk(3, 200);
+	TEST_ASSERT_TRUE(blks_pt[3] > blks_pt[2] && blks_pt[3] < blks_pt[4]);
+	TEST_ASSERT_EQUAL_INT(0, pool_check());
+	free_blks();
+	TEST_ASSERT_EQUAL_INT(0, check_pool_free_space());
+}
+
+
+// The free space must be fully recovered whatever the policy
+void test_policies_recovering(void) {
+
+	int policies[3] = {POOL_FIT_FIRST, POOL_FIT_BEST, POOL_FIT_WORST};
+
+	for (int p=0; p<3; p++) {
+		TEST_ASSERT_EQUAL_INT(0, pool_init_mode(arena, ARENA_SIZE, POOL_MODE_LIST | policies[p]));
+		for (unsigned int chunk_size=1; chunk_size<ARENA_SIZE/8; chunk_size+=13) {
+			alloc_blks(chunk_size);
+			fill_blks(chunk_size);
+			free_blk(2);
+			free_blk(7);
+			free_blk(3);
+			alloc_blk(2, chunk_size/3+1);
+			alloc_blk(7, chunk_size/3+1);
+			fill_blk(2, chunk_size/3+1);
+			fill_blk(7, chunk_size/3+1);
+			check_blks(chunk_size/3+1);
+			TEST_ASSERT_EQUAL_INT(0, pool_check());
+			free_blks();
+			TEST_ASSERT_EQUAL_INT(0, pool_check());
+			TEST_ASSERT_EQUAL_INT(0, check_pool_free_space());
+		}
+	}
+}
+
+
+// Same stress than test_free_space_recovering() but with the size tree
+void test_tree(void) {
+
+	unsigned int chunk_size;
+	chunk_size = 1;
+
+    TEST_ASSERT_EQUAL_INT(0, pool_init_mode(arena, ARENA_SIZE, POOL_MODE_TREE));
+
+	while (chunk_size < ARENA_SIZE) {
+
+		alloc_blks(chunk_size);
+		fill_blks(chunk_size);
+		check_blks(chunk_size);
+		TEST_ASSERT_EQUAL_INT(0, pool_check());
+		free_blk(1);
+		free_blk(5);
+		free_blk(2);
+		free_blk(11);
+		TEST_ASSERT_EQUAL_INT(0, pool_check());
+		alloc_blks(chunk_size/2+1);
+		TEST_ASSERT_EQUAL_INT(0, pool_check());
+		free_blks();
+		TEST_ASSERT_EQUAL_INT(0, pool_check());
+		TEST_ASSERT_EQUAL_INT(0, check_pool_free_space());
+		chunk_size += 7;
+	}
+}
+
+
+// The tree always selects the narrowest hole, whatever the policy
+void test_tree_best_fit(void) {
+
+	void * pt;
+
+	pt = place_in_holes(POOL_MODE_TREE | POOL_FIT_WORST);
+	TEST_ASSERT_TRUE(pt == blks_pt[2]);
+	pool_log();
+	TEST_ASSERT_EQUAL_INT(0, pool_check());
+
+	// The hole of 14 registers is now too narrow, the next one wide enough
+	// is the one of 20 registers
+	blks_pt[6] = pool_malloc(10*reg_size);
+	TEST_ASSERT_TRUE(blks_pt[6] == blks_pt[0]);
+	blks_sts[6] = 1;
+	TEST_ASSERT_EQUAL_INT(0, pool_check());
+	TEST_ASSERT_EQUAL_INT(0, pool_free(pt));
+	free_blks();
+	TEST_ASSERT_EQUAL_INT(0, pool_check());
+	TEST_ASSERT_EQUAL_INT(0, check_pool_free_space());
+}
+
+
+// Same stress than test_free_space_recovering() but with the side arrays. The
+// arrays are at the head of the arena, so the whole free space is checked by
+// allocating it back
+void test_soa(void) {
+
+	unsigned int chunk_size;
+	chunk_size = 1;
+
+    TEST_ASSERT_EQUAL_INT(0, pool_init_mode(arena, ARENA_SIZE, POOL_MODE_SOA));
+
+	while (chunk_size < ARENA_SIZE) {
+
+		alloc_blks(chunk_size);
+		fill_blks(chunk_size);
+		check_blks(chunk_size);
+		TEST_ASSERT_EQUAL_INT(0, pool_check());
+		free_blk(1);
+		free_blk(5);
+		free_blk(2);
+		free_blk(11);
+		TEST_ASSERT_EQUAL_INT(0, pool_check());
+		alloc_blks(chunk_size/2+1);
+		TEST_ASSERT_EQUAL_INT(0, pool_check());
+		free_blks();
+		TEST_ASSERT_EQUAL_INT(0, pool_check());
+		alloc_blk(0, ARENA_SIZE/2);
+		TEST_ASSERT_EQUAL_INT(1, blks_sts[0]);
+		free_blk(0);
+		chunk_size += 7;
+	}
+}
+
+
+// The side arrays select the first hole wide enough by address, even
+// behind many narrower ones
+void test_soa_first_fit(void) {
+
+	void * pts[40];
+	void * pt;
+
+	pt = place_in_holes(POOL_MODE_SOA | POOL_FIT_BEST);
+	TEST_ASSERT_TRUE(pt == blks_pt[0]);
+	TEST_ASSERT_EQUAL_INT(0, pool_check());
+
+    TEST_ASSERT_EQUAL_INT(0, pool_init_mode(arena, ARENA_SIZE, POOL_MODE_SOA));
+	for (int i=0; i<40; i++) {
+		pts[i] = pool_malloc(4*reg_size);
+		TEST_ASSERT_NOT_NULL(pts[i]);
+	}
+	for (int i=0; i<40; i+=2)
+		TEST_ASSERT_EQUAL_INT(0, pool_free(pts[i]));
+	// Merges the holes 30, 31 and 32
+	TEST_ASSERT_EQUAL_INT(0, pool_free(pts[31]));
+	pool_log();
+	TEST_ASSERT_EQUAL_INT(0, pool_check());
+
+	pt = pool_malloc(6*reg_size);
+	TEST_ASSERT_TRUE(pt == pts[30]);
+	TEST_ASSERT_EQUAL_INT(0, pool_check());
+	TEST_ASSERT_EQUAL_INT(0, pool_free(pt));
+	for (int i=1; i<40; i+=2) {
+		if (i != 31)
+			TEST_ASSERT_EQUAL_INT(0, pool_free(pts[i]));
+	}
+	TEST_ASSERT_EQUAL_INT(0, pool_check());
+}
+
+
+// With tail carving, the blocks are placed from the end of the arena and the
+// free space is recovered in every list engine's mode
+void test_tail(void) {
+
+	int modes[4] = {POOL_MODE_LIST, POOL_MODE_SEGREGATED, POOL_MODE_TREE, POOL_MODE_SOA};
+
+    TEST_ASSERT_EQUAL_INT(0, pool_init_mode(arena, ARENA_SIZE, POOL_MODE_LIST | POOL_OPT_TAIL));
+	alloc_blk(0, 4*reg_size);
+	alloc_blk(1, 4*reg_size);
+	TEST_ASSERT_TRUE((char *)blks_pt[0] + 4*reg_size == (char *)arena + ARENA_SIZE);
+	TEST_ASSERT_TRUE((char *)blks_pt[1] + 5*reg_size == blks_pt[0]);
+	free_blks();
+	TEST_ASSERT_EQUAL_INT(0, pool_check());
+	TEST_ASSERT_EQUAL_INT(0, check_pool_free_space());
+
+	for (int m=0; m<4; m++) {
+		TEST_ASSERT_EQUAL_INT(0, pool_init_mode(arena, ARENA_SIZE, modes[m] | POOL_OPT_TAIL));
+		for (unsigned int chunk_size=1; chunk_size<ARENA_SIZE/8; chunk_size+=13) {
+			alloc_blks(chunk_size);
+			fill_blks(chunk_size);
+			free_blk(2);
+			free_blk(7);
+			free_blk(3);
+			alloc_blk(2, chunk_size/3+1);
+			alloc_blk(7, chunk_size/3+1);
+			fill_blk(2, chunk_size/3+1);
+			fill_blk(7, chunk_size/3+1);
+			check_blks(chunk_size/3+1);
+			TEST_ASSERT_EQUAL_INT(0, pool_check());
+			free_blks();
+			TEST_ASSERT_EQUAL_INT(0, pool_check());
+			alloc_blk(0, ARENA_SIZE/2);
+			TEST_ASSERT_EQUAL_INT(1, blks_sts[0]);
+			free_blk(0);
+		}
+	}
+}
+
+
+// A free block exactly or nearly fitting a request is consumed, the slack
+// being folded into the allocation, down to the last free block
+void test_exact_fit(void) {
+
+	int modes[4] = {POOL_MODE_LIST, POOL_MODE_SEGREGATED, POOL_MODE_TREE, POOL_MODE_SOA};
+	void * pt;
+	void * hole;
+
+	for (int m=0; m<4; m++) {
+		TEST_ASSERT_EQUAL_INT(0, pool_init_mode(arena, ARENA_SIZE, modes[m] | POOL_FIT_BEST));
+		for (int i=0; i<NB_PT; i++)
+			blks_sts[i] = 0;
+		alloc_blk(0, 10*reg_size);
+		alloc_blk(1, reg_size);
+		alloc_blk(2, 10*reg_size);
+		alloc_blk(3, reg_size);
+		free_blk(0);
+		free_blk(2);
+		TEST_ASSERT_EQUAL_INT(0, pool_check());
+
+		// Exact fit, in one of the two holes
+		pt = pool_malloc(10*reg_size);
+		TEST_ASSERT_TRUE(pt == blks_pt[0] || pt == blks_pt[2]);
+		TEST_ASSERT_EQUAL_INT(10*reg_size, pool_get_size(pt));
+		TEST_ASSERT_EQUAL_INT(0, pool_check());
+
+		// Near exact fit in the other one, the slack is reported by pool_get_size()
+		hole = (pt == blks_pt[0]) ? blks_pt[2] : blks_pt[0];
+		blks_pt[2] = pool_malloc(9*reg_size);
+		TEST_ASSERT_TRUE(blks_pt[2] == hole);
+		TEST_ASSERT_EQUAL_INT(10*reg_size, pool_get_size(blks_pt[2]));
+		blks_sts[2] = 1;
+		TEST_ASSERT_EQUAL_INT(0, pool_check());
+		TEST_ASSERT_EQUAL_INT(0, pool_free(pt));
+		free_blks();
+		TEST_ASSERT_EQUAL_INT(0, pool_check());
+	}
+
+	// The whole arena can be allocated, then no free block remains
+	TEST_ASSERT_EQUAL_INT(0, pool_init(arena, ARENA_SIZE));
+	pt = pool_malloc(ARENA_SIZE - reg_size);
+	TEST_ASSERT_NOT_NULL(pt);
+	TEST_ASSERT_EQUAL_INT(0, pool_check());
+	pool_log();
+	TEST_ASSERT_NULL(pool_malloc(1));
+	TEST_ASSERT_EQUAL_INT(0, pool_free(pt));
+	TEST_ASSERT_EQUAL_INT(0, pool_check());
+	TEST_ASSERT_EQUAL_INT(0, check_pool_free_space());
+}
+
+
+// The small blocks released are reused in LIFO order without merging, then
+// merged back by pool_consolidate() or when no free block is wide enough
+void test_quick(void) {
+
+	void * pt;
+
+    TEST_ASSERT_EQUAL_INT(0, pool_init_mode(arena, ARENA_SIZE, POOL_MODE_LIST | POOL_OPT_QUICK));
+	for (int i=0; i<6; i++)
+		alloc_blk(i, 4*reg_size);
+	fill_blks(4*reg_size);
+	free_blk(1);
+	free_blk(2);
+	free_blk(4);
+	TEST_ASSERT_EQUAL_INT(0, pool_check());
+	pool_log();
+
+	// The blocks are cached, not merged: the last one released is reused first
+	pt = pool_malloc(4*reg_size);
+	TEST_ASSERT_TRUE(pt == blks_pt[4]);
+	TEST_ASSERT_EQUAL_INT(0, pool_free(pt));
+	check_blks(4*reg_size);
+
+	// A request too wide for the free space merges back the quick bins
+	free_blks();
+	TEST_ASSERT_EQUAL_INT(0, pool_check());
+	pt = pool_malloc(ARENA_SIZE - reg_size);
+	TEST_ASSERT_TRUE(pt == (char *)arena + reg_size);
+	TEST_ASSERT_EQUAL_INT(0, pool_free(pt));
+	TEST_ASSERT_EQUAL_INT(0, pool_check());
+	TEST_ASSERT_EQUAL_INT(0, check_pool_free_space());
+
+	// Wide blocks aren't cached
+	alloc_blk(0, 3*reg_size);
+	alloc_blk(1, 64*reg_size);
+	free_blk(1);
+	free_blk(0);
+	TEST_ASSERT_EQUAL_INT(1, pool_consolidate());
+	TEST_ASSERT_EQUAL_INT(0, pool_consolidate());
+	TEST_ASSERT_EQUAL_INT(0, pool_check());
+	TEST_ASSERT_EQUAL_INT(0, check_pool_free_space());
+}
+
+
+// Same stress than test_policies_recovering() with the quick bins, in every
+// list engine's mode
+void test_quick_recovering(void) {
+
+	int modes[4] = {POOL_MODE_LIST, POOL_MODE_SEGREGATED, POOL_MODE_TREE, POOL_MODE_SOA};
+
+	for (int m=0; m<4; m++) {
+		TEST_ASSERT_EQUAL_INT(0, pool_init_mode(arena, ARENA_SIZE, modes[m] | POOL_OPT_QUICK));
+		for (unsigned int chunk_size=1; chunk_size<ARENA_SIZE/8; chunk_size+=13) {
+			alloc_blks(chunk_size);
+			fill_blks(chunk_size);
+			free_blk(2);
+			free_blk(7);
+			free_blk(3);
+			alloc_blk(2, chunk_size/3+1);
+			alloc_blk(7, chunk_size/3+1);
+			fill_blk(2, chunk_size/3+1);
+			fill_blk(7, chunk_size/3+1);
+			check_blks(chunk_size/3+1);
+			TEST_ASSERT_EQUAL_INT(0, pool_check());
+			free_blks();
+			TEST_ASSERT_EQUAL_INT(0, pool_check());
+			pool_consolidate();
+			TEST_ASSERT_EQUAL_INT(0, pool_check());
+			alloc_blk(0, ARENA_SIZE/2);
+			TEST_ASSERT_EQUAL_INT(1, blks_sts[0]);
+			free_blk(0);
+			pool_consolidate();
+		}
+	}
+}
+
+
+// The small blocks are placed from the low end and the large ones from the
+// high end, so both populations never interleave
+void test_double(void) {
+
+	int modes[2] = {POOL_MODE_LIST, POOL_MODE_SOA};
+	void * low;
+	void * high;
+
+	for (int m=0; m<2; m++) {
+		TEST_ASSERT_EQUAL_INT(0, pool_init_mode(arena, ARENA_SIZE, modes[m] | POOL_OPT_DOUBLE));
+		for (int i=0; i<NB_PT; i++)
+			alloc_blk(i, (i % 2) ? POOL_ARENA_LARGE + i*reg_size : 1 + i*reg_size);
+		fill_blks(1);
+
+		// The first large block is at the end of the arena
+		TEST_ASSERT_TRUE((char *)blks_pt[1] + pool_get_size(blks_pt[1]) == (char *)arena + ARENA_SIZE);
+		low = blks_pt[0];
+		high = blks_pt[1];
+		for (int i=0; i<NB_PT; i+=2) {
+			TEST_ASSERT_TRUE(blks_pt[i] >= low);
+			low = blks_pt[i];
+		}
+		for (int i=1; i<NB_PT; i+=2) {
+			TEST_ASSERT_TRUE(blks_pt[i] <= high && blks_pt[i] > low);
+			high = blks_pt[i];
+		}
+		TEST_ASSERT_EQUAL_INT(0, pool_check());
+
+		// The holes are reused from their own end
+		free_blk(2);
+		free_blk(5);
+		alloc_blk(2, 1);
+		alloc_blk(5, POOL_ARENA_LARGE);
+		TEST_ASSERT_TRUE(blks_pt[2] < blks_pt[4]);
+		TEST_ASSERT_TRUE(blks_pt[5] > blks_pt[7]);
+		fill_blk(2, 1);
+		fill_blk(5, 1);
+		check_blks(1);
+		TEST_ASSERT_EQUAL_INT(0, pool_check());
+		pool_log();
+
+		free_blks();
+		TEST_ASSERT_EQUAL_INT(0, pool_check());
+		alloc_blk(0, ARENA_SIZE/2);
+		TEST_ASSERT_EQUAL_INT(1, blks_sts[0]);
+		free_blk(0);
+	}
+}
+
+
+// The sizes the most requested over a window get a cache list, dropped once
+// the traffic moved to other sizes
+void test_adapt(void) {
+
+	void * pt;
+
+    TEST_ASSERT_EQUAL_INT(0, pool_init_mode(arena, ARENA_SIZE, POOL_MODE_LIST | POOL_OPT_ADAPT));
+
+	// Nothing is cached during the warm-up
+	for (int i=0; i<POOL_ARENA_ADAPT_WINDOW-1; i++)
+		TEST_ASSERT_EQUAL_INT(0, pool_free(pool_malloc(5*reg_size)));
+	TEST_ASSERT_EQUAL_INT(0, pool_consolidate());
+
+	// The end of the window elects the size: its blocks are cached and reused as is
+	alloc_blk(0, 5*reg_size);
+	alloc_blk(1, 5*reg_size);
+	fill_blks(5*reg_size);
+	free_blk(0);
+	TEST_ASSERT_EQUAL_INT(0, pool_check());
+	pool_log();
+	pt = pool_malloc(5*reg_size);
+	TEST_ASSERT_TRUE(pt == blks_pt[0]);
+	TEST_ASSERT_EQUAL_INT(0, pool_free(pt));
+	TEST_ASSERT_EQUAL_INT(1, pool_consolidate());
+
+	// The traffic moves to other sizes: the size is no longer hot after two windows
+	for (int i=0; i<2*POOL_ARENA_ADAPT_WINDOW; i++)
+		TEST_ASSERT_EQUAL_INT(0, pool_free(pool_malloc((6 + i%4)*reg_size)));
+	TEST_ASSERT_EQUAL_INT(0, pool_check());
+	pool_consolidate();
+	check_blks(5*reg_size);
+	free_blk(1);
+	TEST_ASSERT_EQUAL_INT(0, pool_consolidate());
+	TEST_ASSERT_EQUAL_INT(0, pool_check());
+	TEST_ASSERT_EQUAL_INT(0, check_pool_free_space());
+}
+
+
+// The blocks of the declared sizes are taken from their zone, at the head of
+// the arena, the other ones and the zone exhausted from the free space
+void test_zones(void) {
+
+	pool_zone_t zones[2] = {{3*reg_size, 4}, {8*reg_size, 2}};
+	pool_zone_t twins[2] = {{3*reg_size, 4}, {3*reg_size - 1, 2}};
+	char * head = (char *)arena + reg_size;
+	void * pt;
+
+    TEST_ASSERT_EQUAL_INT(-1, pool_init_zones(arena, ARENA_SIZE, twins, 2));
+    TEST_ASSERT_EQUAL_INT(-1, pool_init_zones(arena, 32*reg_size, zones, 2));
+    // The arena itself is invalid, whatever the zones
+    TEST_ASSERT_EQUAL_INT(-1, pool_init_zones(NULL, 0, NULL, 0));
+    TEST_ASSERT_EQUAL_INT(-1, pool_init_zones(arena, 4, NULL, 0));
+    TEST_ASSERT_EQUAL_INT(0, pool_init_zones(arena, ARENA_SIZE, NULL, 0));
+    TEST_ASSERT_EQUAL_INT(0, pool_init_zones(arena, ARENA_SIZE, zones, 2));
+	TEST_ASSERT_EQUAL_INT(0, pool_check());
+
+	for (int i=0; i<5; i++)
+		alloc_blk(i, 3*reg_size);
+	for (int i=0; i<4; i++)
+		TEST_ASSERT_TRUE(blks_pt[i] == head + i*4*reg_size);
+	TEST_ASSERT_TRUE((char *)blks_pt[4] >= head + 4*4*reg_size + 2*9*reg_size);
+	alloc_blk(5, 8*reg_size);
+	alloc_blk(6, 8*reg_size);
+	TEST_ASSERT_TRUE(blks_pt[5] == head + 4*4*reg_size);
+	fill_blks(3*reg_size);
+	TEST_ASSERT_EQUAL_INT(0, pool_check());
+	pool_log();
+
+	// A block released goes back to its zone, and is reused first
+	free_blk(1);
+	pt = pool_malloc(3*reg_size);
+	TEST_ASSERT_TRUE(pt == blks_pt[1]);
+	TEST_ASSERT_EQUAL_INT(0, pool_free(pt));
+	check_blks(3*reg_size);
+
+	// The zones stay reserved once all released, handed out in LIFO order
+	free_blks();
+	TEST_ASSERT_EQUAL_INT(0, pool_consolidate());
+	TEST_ASSERT_EQUAL_INT(0, pool_check());
+	pt = pool_malloc(3*reg_size);
+	TEST_ASSERT_TRUE(pt == head + 3*4*reg_size);
+	TEST_ASSERT_EQUAL_INT(0, pool_free(pt));
+	TEST_ASSERT_EQUAL_INT(0, pool_free(pool_malloc(ARENA_SIZE/2)));
+	TEST_ASSERT_EQUAL_INT(0, pool_check());
+}
+
+
+// An arena and a block beyond 4 GB, reserved without being backed: only
+// the blocks' headers are written
+void test_wide(void) {
+
+	#if POOL_ARENA_WIDE && defined(__linux__) && UINTPTR_MAX > 0xFFFFFFFFu
+	pool_size_t size = (pool_size_t)6 << 30;
+	int modes[3] = {POOL_MODE_LIST, POOL_MODE_SEGREGATED, POOL_MODE_TREE | POOL_OPT_TAIL};
+	void * wide;
+	void * big;
+	void * small;
+
+	wide = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE,
+				-1, 0);
+	TEST_ASSERT_TRUE(wide != MAP_FAILED);
+	for (int m=0; m<3; m++) {
+		TEST_ASSERT_EQUAL_INT(0, pool_init_mode(wide, size, modes[m]));
+		small = pool_malloc(64);
+		big = pool_malloc((pool_size_t)5 << 30);
+		TEST_ASSERT_NOT_NULL(small);
+		TEST_ASSERT_NOT_NULL(big);
+		TEST_ASSERT_TRUE(pool_get_size(big) >= (pool_size_t)5 << 30);
+		TEST_ASSERT_EQUAL_INT(0, pool_check());
+		TEST_ASSERT_NULL(pool_malloc((pool_size_t)2 << 30));
+		TEST_ASSERT_EQUAL_INT(0, pool_free(big));
+		TEST_ASSERT_EQUAL_INT(0, pool_free(small));
+		TEST_ASSERT_EQUAL_INT(0, pool_check());
+	}
+	munmap(wide, size);
+	#endif
+}
+
+
+// The lifetime hints don't limit the arena: a 2 GB arena serves a 1.5 GB
+// block. With the boundary tags, the hints can't be flagged on such arena
+// and are rejected, the arena itself serving the blocks
+void test_large_arena(void) {
+
+	#if defined(__linux__) && UINTPTR_MAX > 0xFFFFFFFFu
+	pool_size_t size = (pool_size_t)2 << 30;
+	int modes[3] = {POOL_MODE_LIST, POOL_MODE_SEGREGATED, POOL_MODE_TREE};
+	void * large;
+	void * pt;
+
+	large = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE,
+				-1, 0);
+	TEST_ASSERT_TRUE(large != MAP_FAILED);
+	for (int m=0; m<3; m++) {
+		TEST_ASSERT_EQUAL_INT(0, pool_init_mode(large, size, modes[m]));
+		pt = pool_malloc_hint((pool_size_t)3 << 29, POOL_HINT_LONG);
+		#if POOL_ARENA_BTAG && !POOL_ARENA_WIDE
+		TEST_ASSERT_NULL(pt);
+		TEST_ASSERT_NULL(pool_malloc_hint(64, POOL_HINT_SHORT));
+		#else
+		TEST_ASSERT_NOT_NULL(pt);
+		TEST_ASSERT_TRUE(pool_get_size(pt) >= (pool_size_t)3 << 29);
+		TEST_ASSERT_EQUAL_INT(0, pool_check());
+		TEST_ASSERT_EQUAL_INT(0, pool_free(pt));
+		#endif
+		pt = pool_malloc((pool_size_t)3 << 29);
+		TEST_ASSERT_NOT_NULL(pt);
+		TEST_ASSERT_TRUE(pool_get_size(pt) >= (pool_size_t)3 << 29);
+		TEST_ASSERT_NOT_NULL(pool_malloc_hint(64, 0));
+		TEST_ASSERT_EQUAL_INT(0, pool_check());
+		TEST_ASSERT_EQUAL_INT(0, pool_free(pt));
+		TEST_ASSERT_EQUAL_INT(0, pool_check());
+	}
+	munmap(large, size);
+	#endif
+}
+
+
+// The blocks follow each other in the ring, a block released out of order is
+// reclaimed with the oldest one, and a stream of buffers wraps around the ring
+void test_ring(void) {
+
+	void * win[8];
+	int wraps = 0;
+
+	TEST_ASSERT_EQUAL_INT(0, pool_init_mode(arena, ARENA_SIZE, POOL_MODE_RING));
+	TEST_ASSERT_NULL(pool_malloc(0));
+	TEST_ASSERT_NULL(pool_malloc(ARENA_SIZE));
+
+	for (int i=0; i<NB_PT; i++) {
+		alloc_blk(i, 1 + i*10);
+		TEST_ASSERT_EQUAL_INT((i*10/8 + 1) * 8, pool_get_size(blks_pt[i]));
+		if (i)
+			TEST_ASSERT_TRUE((char *)blks_pt[i] == (char *)blks_pt[i-1] + pool_get_size(blks_pt[i-1]) + 8);
+	}
+	fill_blks(1);
+	TEST_ASSERT_EQUAL_INT(0, pool_check());
+	pool_log();
+
+	// Neither an address inside a block nor a double release is accepted
+	TEST_ASSERT_EQUAL_INT(-1, pool_free((char *)blks_pt[8] + 8));
+	TEST_ASSERT_EQUAL_INT(-1, pool_free(arena));
+	free_blk(2);
+	TEST_ASSERT_EQUAL_INT(-1, pool_free(blks_pt[2]));
+	free_blk(1);
+	TEST_ASSERT_EQUAL_INT(0, pool_check());
+	pool_log();
+	free_blk(0);
+	check_blks(1);
+	TEST_ASSERT_EQUAL_INT(0, pool_check());
+	free_blks();
+	TEST_ASSERT_EQUAL_INT(0, pool_check());
+
+	// A stream of buffers, the oldest one released after each allocation
+	for (int i=0; i<8; i++)
+		win[i] = NULL;
+	for (int n=0; n<2000; n++) {
+		if (win[n % 8] != NULL) {
+			TEST_ASSERT_EQUAL_INT(n & 0xFF, ((unsigned char *)win[n % 8])[0]);
+			TEST_ASSERT_EQUAL_INT(0, pool_free(win[n % 8]));
+		}
+		win[n % 8] = pool_malloc(100 + n % 150);
+		TEST_ASSERT_NOT_NULL(win[n % 8]);
+		TEST_ASSERT_TRUE((char *)win[n % 8] + pool_get_size(win[n % 8]) <= (char *)arena + ARENA_SIZE);
+		wraps += n > 0 && win[n % 8] < win[(n - 1) % 8];
+		memset(win[n % 8], (n + 8) & 0xFF, pool_get_size(win[n % 8]));
+	}
+	TEST_ASSERT_TRUE(wraps > 10);
+	TEST_ASSERT_EQUAL_INT(0, pool_check());
+	for (int i=0; i<8; i++)
+		TEST_ASSERT_EQUAL_INT(0, pool_free(win[i]));
+	TEST_ASSERT_EQUAL_INT(0, pool_check());
+	TEST_ASSERT_NOT_NULL(pool_malloc(ARENA_SIZE - 16));
+}
+
+
+// A mirrored ring places a block across its end, the bytes past the end being
+// the ones of its start, where the ring not mirrored pads its end
+void test_ring_mirror(void) {
+
+	#if defined(__linux__)
+	long page = sysconf(_SC_PAGESIZE);
+	char * ring = pool_ring_mirror(page);
+	char * pt;
+
+	TEST_ASSERT_NOT_NULL(ring);
+	TEST_ASSERT_NULL(pool_ring_mirror(page));
+
+	TEST_ASSERT_EQUAL_INT(0, pool_init_mode(ring, page, POOL_MODE_RING));
+	pt = pool_malloc(page/2 - 8);
+	TEST_ASSERT_NOT_NULL(pool_malloc(page/4 - 8));
+	TEST_ASSERT_EQUAL_INT(0, pool_free(pt));
+	pt = pool_malloc(page/2 - 8);
+	TEST_ASSERT_TRUE(pt == ring + 3*page/4 + 8);
+	memset(pt, 0x5A, page/2 - 8);
+	for (int i=0; i<page/4; i++)
+		TEST_ASSERT_EQUAL_INT(0x5A, (unsigned char)ring[i]);
+	TEST_ASSERT_EQUAL_INT(0, pool_check());
+	pool_log();
+
+	TEST_ASSERT_EQUAL_INT(0, pool_init_mode(ring, page - 8, POOL_MODE_RING));
+	pt = pool_malloc(page/2 - 8);
+	TEST_ASSERT_NOT_NULL(pool_malloc(page/4 - 8));
+	TEST_ASSERT_EQUAL_INT(0, pool_free(pt));
+	pt = pool_malloc(page/2 - 8);
+	TEST_ASSERT_TRUE(pt == ring + 8);
+	TEST_ASSERT_EQUAL_INT(0, pool_check());
+
+	TEST_ASSERT_EQUAL_INT(0, pool_ring_unmirror(ring));
+	TEST_ASSERT_EQUAL_INT(-1, pool_ring_unmirror(ring));
+	#endif
+}
+
+
+// The blocks of a scope are bumped in its region and reclaimed at once when
+// it ends, a nested scope restoring the top of the region it marked
+void test_scopes(void) {
+
+	int modes[3] = {POOL_MODE_LIST, POOL_MODE_TREE, POOL_MODE_TLSF};
+	char * pt;
+	int depth;
+
+	for (int m=0; m<3; m++) {
+		TEST_ASSERT_EQUAL_INT(0, pool_init_mode(arena, ARENA_SIZE, modes[m]));
+		TEST_ASSERT_EQUAL_INT(-1, pool_scope_end());
+		TEST_ASSERT_EQUAL_INT(-1, pool_scope_begin(0));
+		TEST_ASSERT_EQUAL_INT(0, pool_scope_begin(32*reg_size));
+		for (int i=0; i<8; i++) {
+			blks_pt[i] = pool_malloc(1 + i%reg_size);
+			TEST_ASSERT_NOT_NULL(blks_pt[i]);
+			TEST_ASSERT_EQUAL_INT(reg_size, pool_get_size(blks_pt[i]));
+			if (i > 0)
+				TEST_ASSERT_TRUE((char *)blks_pt[i] == (char *)blks_pt[i-1] + 2*reg_size);
+		}
+		// A block of the scope isn't released, the next one is bumped after
+		TEST_ASSERT_EQUAL_INT(0, pool_free(blks_pt[7]));
+		pt = pool_calloc(2*reg_size);
+		TEST_ASSERT_TRUE(pt == (char *)blks_pt[7] + 2*reg_size);
+
+		// A nested scope gives back its blocks
+		TEST_ASSERT_EQUAL_INT(0, pool_scope_begin(0));
+		blks_pt[8] = pool_malloc(4*reg_size);
+		TEST_ASSERT_TRUE((char *)blks_pt[8] == pt + 3*reg_size);
+		TEST_ASSERT_NULL(pool_malloc(32*reg_size));
+		TEST_ASSERT_EQUAL_INT(0, pool_scope_end());
+		TEST_ASSERT_TRUE(pool_malloc(reg_size) == blks_pt[8]);
+
+		for (depth=1; depth<POOL_ARENA_SCOPES; depth++)
+			TEST_ASSERT_EQUAL_INT(0, pool_scope_begin(0));
+		TEST_ASSERT_EQUAL_INT(-1, pool_scope_begin(0));
+		pool_log();
+		while (depth-- > 0)
+			TEST_ASSERT_EQUAL_INT(0, pool_scope_end());
+
+		// The region is back in the free space
+		TEST_ASSERT_EQUAL_INT(-1, pool_scope_end());
+		TEST_ASSERT_EQUAL_INT(0, pool_check());
+		TEST_ASSERT_EQUAL_INT(0, pool_free(pool_malloc(ARENA_SIZE/4)));
+		if (modes[m] == POOL_MODE_LIST)
+			TEST_ASSERT_EQUAL_INT(0, check_pool_free_space());
+	}
+}
+
+
+// pool_reset() drops the blocks, the caches, the scopes and the zones
+void test_reset(void) {
+
+	int modes[4] = {POOL_MODE_LIST | POOL_OPT_QUICK, POOL_MODE_SOA, POOL_MODE_BUDDY, POOL_MODE_BITMAP};
+	pool_zone_t zones[1] = {{2*reg_size, 8}};
+
+	char * head = (char *)arena + reg_size;
+
+	// The zones are carved again, their first block handed out first
+	TEST_ASSERT_EQUAL_INT(0, pool_init_zones(arena, ARENA_SIZE, zones, 1));
+	TEST_ASSERT_TRUE(pool_malloc(2*reg_size) == head);
+	TEST_ASSERT_TRUE(pool_malloc(2*reg_size) > (void *)head);
+	TEST_ASSERT_EQUAL_INT(0, pool_reset());
+	TEST_ASSERT_EQUAL_INT(0, pool_check());
+	TEST_ASSERT_TRUE(pool_malloc(2*reg_size) == head);
+	TEST_ASSERT_EQUAL_INT(0, pool_check());
+
+	for (int m=0; m<4; m++) {
+		TEST_ASSERT_EQUAL_INT(0, pool_init_mode(arena, ARENA_SIZE, modes[m]));
+		for (int i=0; i<NB_PT; i++)
+			TEST_ASSERT_NOT_NULL(pool_malloc(8 + i*reg_size));
+		pool_free(pool_malloc(reg_size));
+		TEST_ASSERT_EQUAL_INT(0, pool_scope_begin(16*reg_size));
+		TEST_ASSERT_NOT_NULL(pool_malloc(reg_size));
+		TEST_ASSERT_EQUAL_INT(0, pool_reset());
+		TEST_ASSERT_EQUAL_INT(-1, pool_scope_end());
+		TEST_ASSERT_EQUAL_INT(0, pool_check());
+		TEST_ASSERT_EQUAL_INT(0, pool_free(pool_malloc(ARENA_SIZE/4)));
+		TEST_ASSERT_EQUAL_INT(0, pool_check());
+	}
+
+	// An init which failed doesn't change the arena pool_reset() gets back
+	TEST_ASSERT_EQUAL_INT(0, pool_init_mode(arena, ARENA_SIZE/2, POOL_MODE_LIST));
+	TEST_ASSERT_EQUAL_INT(-1, pool_init_mode(arena, ARENA_SIZE, 15));
+	TEST_ASSERT_EQUAL_INT(-1, pool_init_mode(arena, 4, POOL_MODE_LIST));
+	TEST_ASSERT_EQUAL_INT(0, pool_reset());
+	TEST_ASSERT_NULL(pool_malloc(ARENA_SIZE/2));
+	TEST_ASSERT_NOT_NULL(pool_malloc(ARENA_SIZE/4));
+	TEST_ASSERT_EQUAL_INT(0, pool_check());
+}
+
+
+// The short-lived blocks are placed from the low end, the long-lived ones
+// from the high end, and pool_check() checks their accounting
+void test_hints(void) {
+
+	int modes[3] = {POOL_MODE_LIST, POOL_MODE_SOA, POOL_MODE_LIST | POOL_OPT_QUICK};
+	pool_size_t * reg;
+
+	for (int m=0; m<3; m++) {
+		TEST_ASSERT_EQUAL_INT(0, pool_init_mode(arena, ARENA_SIZE, modes[m]));
+		for (int i=0; i<NB_PT; i++) {
+			blks_pt[i] = pool_malloc_hint(8 + i*reg_size, (i < 8) ? POOL_HINT_SHORT : POOL_HINT_LONG);
+			TEST_ASSERT_NOT_NULL(blks_pt[i]);
+			blks_sts[i] = 1;
+		}
+		fill_blks(8);
+		for (int i=1; i<8; i++)
+			TEST_ASSERT_TRUE(blks_pt[i] > blks_pt[i-1]);
+		for (int i=9; i<NB_PT; i++)
+			TEST_ASSERT_TRUE(blks_pt[i] < blks_pt[i-1] && blks_pt[i] > blks_pt[7]);
+		TEST_ASSERT_EQUAL_INT(0, pool_check());
+
+		// A hint lost or changed is detected
+		reg = (pool_size_t *)((char *)blks_pt[3] - reg_size);
+		*reg ^= HINT_LONG_BIT;
+		TEST_ASSERT_EQUAL_INT(1, pool_check());
+		*reg ^= HINT_LONG_BIT;
+		TEST_ASSERT_EQUAL_INT(0, pool_check());
+
+		// A block released and allocated again without hint isn't accounted
+		free_blk(2);
+		free_blk(12);
+		alloc_blk(2, 8 + 2*reg_size);
+		fill_blk(2, 8);
+		check_blks(8);
+		TEST_ASSERT_EQUAL_INT(0, pool_check());
+		pool_log();
+		free_blks();
+		pool_consolidate();
+		TEST_ASSERT_EQUAL_INT(0, pool_check());
+		TEST_ASSERT_EQUAL_INT(0, pool_free(pool_malloc(ARENA_SIZE/2)));
+	}
+}
+
+
+// Same stress than test_free_space_recovering() but with the TLSF engine
+void test_tlsf(void) {
+
+	unsigned int chunk_size;
+	chunk_size = 1;
+
+    TEST_ASSERT_EQUAL_INT(0, pool_init_mode(arena, ARENA_SIZE, POOL_MODE_TLSF));
+    TEST_ASSERT_EQUAL_INT(ARENA_SIZE-sizeof(void *), pool_get_size((char *)arena + sizeof(void *)));
+
+	while (chunk_size < ARENA_SIZE) {
+
+		alloc_blks(chunk_size);
+		fill_blks(chunk_size);
+		check_blks(chunk_size);
+		TEST_ASSERT_EQUAL_INT(0, pool_check());
+		free_blk(1);
+		free_blk(5);
+		free_blk(2);
+		free_blk(9);
+		TEST_ASSERT_EQUAL_INT(0, pool_check());
+		alloc_blks(chunk_size/2+1);
+		fill_blks(chunk_size/2+1);
+		check_blks(chunk_size/2+1);
+		TEST_ASSERT_EQUAL_INT(0, pool_check());
+		free_blks();
+		TEST_ASSERT_EQUAL_INT(0, pool_check());
+		TEST_ASSERT_EQUAL_INT(ARENA_SIZE-sizeof(void *), pool_get_size((char *)arena + sizeof(void *)));
+		chunk_size += 7;
+	}
+}
+
+
+// The whole TLSF arena can be allocated, then released in any order
+void test_tlsf_full(void) {
+
+    TEST_ASSERT_EQUAL_INT(0, pool_init_mode(arena, ARENA_SIZE, POOL_MODE_TLSF));
+    TEST_ASSERT_NULL(pool_malloc(0));
+    TEST_ASSERT_NULL(pool_malloc(ARENA_SIZE));
+
+	// 16 blocks filling exactly the arena
+	for (int i=0; i<NB_PT; i++)
+		alloc_blk(i, ARENA_SIZE/NB_PT - sizeof(void *));
+	for (int i=0; i<NB_PT; i++)
+		TEST_ASSERT_EQUAL_INT(1, blks_sts[i]);
+	TEST_ASSERT_NULL(pool_malloc(1));
+	TEST_ASSERT_EQUAL_INT(0, pool_check());
+	pool_log();
+
+	free_blk(15);
+	free_blk(0);
+	free_blk(7);
+	free_blk(6);
+	free_blk(8);
+	TEST_ASSERT_EQUAL_INT(0, pool_check());
+	TEST_ASSERT_EQUAL_INT(-1, pool_free((char *)arena + ARENA_SIZE));
+
+	// realloc()/calloc() also use the engine
+	blks_pt[0] = pool_calloc(64);
+	TEST_ASSERT_NOT_NULL(blks_pt[0]);
+	blks_pt[0] = pool_realloc(blks_pt[0], 64);
+	TEST_ASSERT_NOT_NULL(blks_pt[0]);
+	TEST_ASSERT_EQUAL_INT(0, pool_check());
+
+	free_blks();
+	TEST_ASSERT_EQUAL_INT(0, pool_free(blks_pt[0]));
+	TEST_ASSERT_EQUAL_INT(0, pool_check());
+	TEST_ASSERT_EQUAL_INT(ARENA_SIZE-sizeof(void *), pool_get_size((char *)arena + sizeof(void *)));
+}
+
+
+// Allocates power-of-two blocks then check they are merged back on release
+void test_buddy(void) {
+
+	void * first;
+
+    TEST_ASSERT_EQUAL_INT(0, pool_init_mode(arena, ARENA_SIZE, POOL_MODE_BUDDY));
+    TEST_ASSERT_EQUAL_INT(0, pool_check());
+    TEST_ASSERT_NULL(pool_malloc(0));
+    TEST_ASSERT_NULL(pool_malloc(ARENA_SIZE));
+
+	// The bitmaps take some space at the head, so the widest block is 8KB
+	first = pool_malloc(8192);
+    TEST_ASSERT_NOT_NULL(first);
+    TEST_ASSERT_EQUAL_INT(0, (size_t)first % 64);
+    TEST_ASSERT_NULL(pool_malloc(8192));
+    TEST_ASSERT_EQUAL_INT(0, pool_free(first));
+    TEST_ASSERT_EQUAL_INT(0, pool_check());
+
+	// Sizes are round up to the next power of two
+	for (int i=0; i<NB_PT; i++) {
+		alloc_blk(i, 100 + i*10);
+		TEST_ASSERT_EQUAL_INT(1, blks_sts[i]);
+		TEST_ASSERT_EQUAL_INT((i < 3) ? 128 : 256, pool_get_size(blks_pt[i]));
+	}
+	fill_blks(100);
+	TEST_ASSERT_EQUAL_INT(0, pool_check());
+	pool_log();
+
+	// Buddies are contiguous, an invalid or double release is rejected
+	TEST_ASSERT_TRUE((char *)blks_pt[1] == (char *)blks_pt[0] + 128);
+	TEST_ASSERT_EQUAL_INT(-1, pool_free((char *)blks_pt[4] + 16));
+	free_blk(4);
+	TEST_ASSERT_EQUAL_INT(-1, pool_free(blks_pt[4]));
+	void * hole = blks_pt[0];
+	free_blk(0);
+	free_blk(9);
+	check_blks(100);
+	TEST_ASSERT_EQUAL_INT(0, pool_check());
+
+	// The hole left by the block 0 is reused
+	alloc_blk(0, 128);
+	TEST_ASSERT_TRUE(blks_pt[0] == hole);
+
+	// All blocks merged back, the widest block is available again
+	free_blks();
+	TEST_ASSERT_EQUAL_INT(0, pool_check());
+	TEST_ASSERT_TRUE(pool_malloc(8192) == first);
+}
+
+
+// Allocates random sizes until the buddy arena is full and releases them
+void test_buddy_stress(void) {
+
+	void * pts[256];
+	int nb;
+
+    TEST_ASSERT_EQUAL_INT(0, pool_init_mode(arena, ARENA_SIZE - 100, POOL_MODE_BUDDY));
+
+	for (int round=0; round<8; round++) {
+		for (nb=0; nb<256; nb++) {
+			pts[nb] = pool_malloc(1 + (nb * 37 + round * 11) % 700);
+			if (pts[nb] == NULL)
+				break;
+			memset(pts[nb], nb, pool_get_size(pts[nb]));
+		}
+		TEST_ASSERT_EQUAL_INT(0, pool_check());
+		for (int i=round%2; i<nb; i+=2)
+			TEST_ASSERT_EQUAL_INT(0, pool_free(pts[i]));
+		TEST_ASSERT_EQUAL_INT(0, pool_check());
+		for (int i=1-round%2; i<nb; i+=2) {
+			TEST_ASSERT_EQUAL_INT(i & 0xFF, ((unsigned char *)pts[i])[0]);
+			TEST_ASSERT_EQUAL_INT(0, pool_free(pts[i]));
+		}
+		TEST_ASSERT_EQUAL_INT(0, pool_check());
+	}
+}
+
+
+// Allocates granules' runs, checks the holes are reused first-fit and the
+// invalid releases are rejected
+void test_bitmap(void) {
+
+	void * first;
+	void * pt;
+
+    TEST_ASSERT_EQUAL_INT(0, pool_init_mode(arena, ARENA_SIZE, POOL_MODE_BITMAP));
+    TEST_ASSERT_EQUAL_INT(0, pool_check());
+    TEST_ASSERT_NULL(pool_malloc(0));
+    TEST_ASSERT_NULL(pool_malloc(ARENA_SIZE));
+
+	// Sizes are round up to the next granule, the blocks are contiguous
+	for (int i=0; i<NB_PT; i++) {
+		alloc_blk(i, 1 + i*10);
+		TEST_ASSERT_EQUAL_INT(1, blks_sts[i]);
+		TEST_ASSERT_EQUAL_INT((i*10/16 + 1) * 16, pool_get_size(blks_pt[i]));
+		#if !POOL_ARENA_NATURAL
+		if (i)
+			TEST_ASSERT_TRUE((char *)blks_pt[i] == (char *)blks_pt[i-1] + pool_get_size(blks_pt[i-1]));
+		#endif
+	}
+	first = blks_pt[0];
+	fill_blks(1);
+	TEST_ASSERT_EQUAL_INT(0, pool_check());
+	pool_log();
+
+	// Neither an address inside a block nor a double release is accepted
+	TEST_ASSERT_EQUAL_INT(-1, pool_free((char *)blks_pt[8] + 16));
+	TEST_ASSERT_EQUAL_INT(-1, pool_free((char *)blks_pt[8] + 1));
+	TEST_ASSERT_EQUAL_INT(-1, pool_free(arena));
+	free_blk(8);
+	TEST_ASSERT_EQUAL_INT(-1, pool_free(blks_pt[8]));
+	free_blk(9);
+	free_blk(2);
+	check_blks(1);
+	TEST_ASSERT_EQUAL_INT(0, pool_check());
+
+	// The holes 8 and 9 (96 bytes each) form a single run without any
+	// merging step, a request too wide for the hole 2 goes there
+	#if !POOL_ARENA_NATURAL
+	pt = pool_malloc(112);
+	TEST_ASSERT_TRUE(pt == blks_pt[8]);
+	TEST_ASSERT_EQUAL_INT(0, pool_free(pt));
+	alloc_blk(2, 16);
+	TEST_ASSERT_TRUE(blks_pt[2] == (char *)first + 32);
+	#else
+	(void)pt;
+	#endif
+
+	free_blks();
+	TEST_ASSERT_EQUAL_INT(0, pool_check());
+	TEST_ASSERT_TRUE(pool_malloc(1) == first);
+}
+
+
+// Fills the bitmap arena with small objects and releases them
+void test_bitmap_stress(void) {
+
+	void * pts[512];
+	int nb;
+
+    TEST_ASSERT_EQUAL_INT(0, pool_init_mode(arena, ARENA_SIZE - 100, POOL_MODE_BITMAP));
+
+	for (int round=0; round<8; round++) {
+		for (nb=0; nb<512; nb++) {
+			pts[nb] = pool_malloc(1 + (nb * 37 + round * 11) % 90);
+			if (pts[nb] == NULL)
+				break;
+			memset(pts[nb], nb, pool_get_size(pts[nb]));
+		}
+		TEST_ASSERT_EQUAL_INT(0, pool_check());
+		for (int i=round%2; i<nb; i+=2)
+			TEST_ASSERT_EQUAL_INT(0, pool_free(pts[i]));
+		TEST_ASSERT_EQUAL_INT(0, pool_check());
+		for (int i=1-round%2; i<nb; i+=2) {
+			TEST_ASSERT_EQUAL_INT(i & 0xFF, ((unsigned char *)pts[i])[0]);
+			TEST_ASSERT_EQUAL_INT(0, pool_free(pts[i]));
+		}
+		TEST_ASSERT_EQUAL_INT(0, pool_check());
+	}
+}
+
+
+// The granules never share a cache line with the bitmaps, and built with
+// POOL_ARENA_NATURAL, the blocks start on their natural alignment
+void test_bitmap_natural(void) {
+
+	unsigned int sizes[8] = {16, 48, 64, 100, 256, 2048, 24, 1024};
+	unsigned int align;
+
+    TEST_ASSERT_EQUAL_INT(0, pool_init_mode((char *)arena + 8, ARENA_SIZE - 8, POOL_MODE_BITMAP));
+	alloc_blk(0, 1);
+	TEST_ASSERT_EQUAL_INT(0, (size_t)blks_pt[0] % 64);
+	free_blks();
+
+	for (int round=0; round<2; round++) {
+		for (int i=0; i<8; i++) {
+			alloc_blk(i, sizes[i]);
+			TEST_ASSERT_EQUAL_INT(1, blks_sts[i]);
+			for (align = 16; POOL_ARENA_NATURAL && align * 2 <= sizes[i] &&
+							 align * 2 <= POOL_ARENA_NATURAL; align *= 2);
+			TEST_ASSERT_EQUAL_INT(0, ((char *)blks_pt[i] - (char *)blks_pt[0]) % align);
+			TEST_ASSERT_EQUAL_INT(0, (size_t)blks_pt[i] % align);
+		}
+		fill_blks(16);
+		check_blks(16);
+		TEST_ASSERT_EQUAL_INT(0, pool_check());
+		// Holes of various sizes for the second round
+		free_blk(1);
+		free_blk(4);
+		free_blk(6);
+	}
+	free_blks();
+	TEST_ASSERT_EQUAL_INT(0, pool_check());
+}
+
+
+// Fills a slab, releases some objects and checks they are reused
+void test_slab(void) {
+
+	pool_slab_t * slab;
+	void * objs[NB_PT];
+	void * pt;
+
+    TEST_ASSERT_EQUAL_INT(0, pool_init(arena, ARENA_SIZE));
+	TEST_ASSERT_NULL(pool_slab_create(0, NB_PT));
+	TEST_ASSERT_NULL(pool_slab_create(24, ARENA_SIZE));
+
+	slab = pool_slab_create(3*sizeof(void *)-1, NB_PT);
+	TEST_ASSERT_NOT_NULL(slab);
+    TEST_ASSERT_EQUAL_INT(0, pool_check());
+
+	for (int i=0; i<NB_PT; i++) {
+		objs[i] = pool_slab_alloc(slab);
+		TEST_ASSERT_NOT_NULL(objs[i]);
+		memset(objs[i], i, 3*sizeof(void *));
+		if (i)
+			TEST_ASSERT_TRUE((char *)objs[i] == (char *)objs[i-1] + 3*sizeof(void *));
+	}
+	TEST_ASSERT_NULL(pool_slab_alloc(slab));
+    TEST_ASSERT_EQUAL_INT(NB_PT, pool_slab_used(slab));
+
+	// Objects are reused in LIFO order
+	TEST_ASSERT_EQUAL_INT(0, pool_slab_free(slab, objs[3]));
+	TEST_ASSERT_EQUAL_INT(0, pool_slab_free(slab, objs[9]));
+	TEST_ASSERT_EQUAL_INT(-1, pool_slab_free(slab, (char *)objs[4] + 1));
+	TEST_ASSERT_EQUAL_INT(-1, pool_slab_free(slab, arena));
+    TEST_ASSERT_EQUAL_INT(NB_PT-2, pool_slab_used(slab));
+	pt = pool_slab_alloc(slab);
+	TEST_ASSERT_TRUE(pt == objs[9]);
+	pt = pool_slab_alloc(slab);
+	TEST_ASSERT_TRUE(pt == objs[3]);
+
+	// The other objects are not corrupted
+	for (int i=0; i<NB_PT; i++) {
+		if (i == 3 || i == 9)
+			continue;
+		for (unsigned int j=0; j<3*sizeof(void *); j++)
+			TEST_ASSERT_EQUAL_INT(i, ((char *)objs[i])[j]);
+	}
+
+	TEST_ASSERT_EQUAL_INT(0, pool_slab_destroy(slab));
+    TEST_ASSERT_EQUAL_INT(0, pool_check());
+	TEST_ASSERT_EQUAL_INT(0, check_pool_free_space());
+}
+
+
+// An unknown mode is rejected
+void test_unknown_mode(void) {
+    TEST_ASSERT_EQUAL_INT(-1, pool_init_mode(arena, ARENA_SIZE, -1));
+}
+
+
 int main(void) {
 
     UNITY_BEGIN();
@@ -431,9 +1901,46 @@ int main(void) {
     RUN_TEST(test_calloc);
     RUN_TEST(test_realloc_ok);
     RUN_TEST(test_realloc_ko);
+    RUN_TEST(test_realloc_in_place);
+    RUN_TEST(test_aligned_alloc);
+    RUN_TEST(test_batch);
+    RUN_TEST(test_comalloc);
     RUN_TEST(test_free_space_recovering);
     RUN_TEST(test_data_integrity);
     RUN_TEST(test_check);
+    RUN_TEST(test_merge_orders);
+    RUN_TEST(test_segregated);
+    RUN_TEST(test_segregated_reuse);
+    RUN_TEST(test_tree);
+    RUN_TEST(test_tree_best_fit);
+    RUN_TEST(test_soa);
+    RUN_TEST(test_soa_first_fit);
+    RUN_TEST(test_tail);
+    RUN_TEST(test_exact_fit);
+    RUN_TEST(test_quick);
+    RUN_TEST(test_quick_recovering);
+    RUN_TEST(test_double);
+    RUN_TEST(test_hints);
+    RUN_TEST(test_adapt);
+    RUN_TEST(test_zones);
+    RUN_TEST(test_wide);
+    RUN_TEST(test_large_arena);
+    RUN_TEST(test_ring);
+    RUN_TEST(test_ring_mirror);
+    RUN_TEST(test_scopes);
+    RUN_TEST(test_reset);
+    RUN_TEST(test_unknown_mode);
+    RUN_TEST(test_policies);
+    RUN_TEST(test_first_fit_order);
+    RUN_TEST(test_policies_recovering);
+    RUN_TEST(test_slab);
+    RUN_TEST(test_tlsf);
+    RUN_TEST(test_tlsf_full);
+    RUN_TEST(test_buddy);
+    RUN_TEST(test_buddy_stress);
+    RUN_TEST(test_bitmap);
+    RUN_TEST(test_bitmap_stress);
+    RUN_TEST(test_bitmap_natural);
 
     return UNITY_END();
 }